@@ -0,0 +1,40 @@
+#!/bin/sh
+#
+# Benchmark of the event output of simple_acceptance_study
+#
+# Usage: ./bench_output.sh [events] (in the build directory)
+#
+# For 1, 8 and 32 worker threads, the same run is made with the records
+# written by the single asynchronous writer (one file) and with one file
+# per worker, then the per-worker files are merged by hcol_merge.
+# The throughput and writer statistics printed at the end of the runs
+# are extracted from the logs (bench_output_<mode>_<threads>.log).
+#
+EVENTS=${1:-100000}
+
+for THREADS in 1 8 32; do
+  for MODE in merged worker; do
+    if [ ${MODE} = worker ]; then PER_WORKER=true; else PER_WORKER=false; fi
+    MACRO=bench_output_${MODE}_${THREADS}.mac
+    LOG=bench_output_${MODE}_${THREADS}.log
+    cat > ${MACRO} <<END
+/run/numberOfThreads ${THREADS}
+/hodoscope/output/perWorkerFiles ${PER_WORKER}
+/run/initialize
+/hodoscope/sd/cdh/detail step
+/hodoscope/sd/disc/detail step
+/hodoscope/output/asyncWriter true
+/hodoscope/output/fileName bench_${MODE}_${THREADS}
+/analysis/setFileName bench_${MODE}_${THREADS}
+/run/beamOn ${EVENTS}
+END
+    rm -f bench_${MODE}_${THREADS}_run0*.hcol
+    ./execute-simple_acceptance_study ${MACRO} > ${LOG} 2>&1
+    echo "== ${THREADS} threads, ${MODE} output"
+    grep -E "events/s|records written|bytes|worker stalls|queue depth" ${LOG}
+    if [ ${MODE} = worker ]; then
+      ./hcol_merge -j ${THREADS} bench_${MODE}_${THREADS}_run0.hcol \
+        bench_${MODE}_${THREADS}_run0_t*.hcol
+    fi
+  done
+done
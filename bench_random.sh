@@ -0,0 +1,55 @@
+#!/bin/sh
+#
+# Benchmark of the random engines of simple_acceptance_study
+#
+# Usage: ./bench_random.sh [events] (in the build directory,
+#        or "make bench_random")
+#
+# rng_bench measures the random numbers/s of every engine. The standard
+# proton run is then made on one thread with each engine
+# (bench_random_<engine>.log), and the difference of the time per event
+# between MixMax and Ranlux at luxury 4, divided by the difference of
+# their time per number, estimates the random numbers used per event
+# and the fraction of the CPU time spent in the engine.
+#
+EVENTS=${1:-100000}
+
+./rng_bench 20000000 | tee bench_random_rng.log
+
+for ENGINE in mixmax ranlux0 ranlux3 ranlux4 ranlux64_1 mtwist ranecu; do
+  case ${ENGINE} in
+    ranlux64_*) NAME=ranlux64; LUXURY=${ENGINE#ranlux64_} ;;
+    ranlux*)    NAME=ranlux;   LUXURY=${ENGINE#ranlux} ;;
+    *)          NAME=${ENGINE}; LUXURY=-1 ;;
+  esac
+  MACRO=bench_random_${ENGINE}.mac
+  LOG=bench_random_${ENGINE}.log
+  cat > ${MACRO} <<END
+/run/numberOfThreads 1
+/hodoscope/random/engine ${NAME}
+/hodoscope/random/luxury ${LUXURY}
+/hodoscope/progress/interval 0
+/run/initialize
+/analysis/setFileName bench_random_${ENGINE}
+/run/beamOn ${EVENTS}
+END
+  ./execute-simple_acceptance_study ${MACRO} > ${LOG} 2>&1
+  RATE=$(grep "throughput" ${LOG} | tail -1 | awk '{print $3}')
+  echo "${ENGINE} ${RATE}" >> bench_random_rates.tmp
+  echo "== ${ENGINE} : ${RATE} events/s"
+done
+
+# time per number [ns] (flat) and per event [ns]
+awk '
+  FNR==NR { if($1!="engine") ns[$1]=$3; next }
+  { ev[$1]=1.e9/$2 }
+  END {
+    if(ns["ranlux4"]>ns["mixmax"] && ev["ranlux4"]>ev["mixmax"]){
+      n = (ev["ranlux4"]-ev["mixmax"])/(ns["ranlux4"]-ns["mixmax"]);
+      printf("estimated random numbers per event : %.0f\n", n);
+      for(e in ev){
+        if(e in ns) printf("  %-12s %6.2f %% of the time per event in the engine\n", e, 100.*n*ns[e]/ev[e]);
+      }
+    }
+  }' bench_random_rng.log bench_random_rates.tmp
+rm -f bench_random_rates.tmp
@@ -0,0 +1,209 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file hcol_merge.cc
+/// \brief Merge of the per-worker columnar event files
+
+// Usage: hcol_merge [-j threads] output.hcol input.hcol...
+//
+// The rows of the inputs are concatenated, in the order of the arguments.
+// The stored blocks are copied as they are (no decompression), each
+// thread writing its share of the blocks at precomputed offsets of the
+// output file.
+
+#include "ColumnarReader.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+  // block of an input, with its place in the output
+  struct MergedBlock {
+    const char* data;
+    Columnar::ColumnBlock block;
+  };
+
+  inline std::uint64_t Padded(const std::uint64_t size)
+  {
+    return (size+7)/8*8;
+  }
+
+  template <class T>
+  inline void AppendValue(std::vector<char>& buffer, const T& value)
+  {
+    auto first = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(),first,first+sizeof(T));
+  }
+
+  bool WriteAt(const int fd, const char* data, std::uint64_t size, std::uint64_t offset)
+  {
+    while(size>0){
+      auto written = pwrite(fd,data,size,offset);
+      if(written<=0) return false;
+      data += written;
+      size -= written;
+      offset += written;
+    }
+    return true;
+  }
+
+  void PrintUsage()
+  {
+    std::cerr << "Usage: hcol_merge [-j threads] output.hcol input.hcol..." << std::endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc,char** argv)
+{
+  unsigned int total_threads = std::max(std::thread::hardware_concurrency(),1u);
+  std::vector<std::string> file_names;
+  for(int i=1;i<argc;i++){
+    if(std::strcmp(argv[i],"-j")==0 && i+1<argc){
+      total_threads = std::max(std::atoi(argv[++i]),1);
+    } else {
+      file_names.push_back(argv[i]);
+    }
+  }
+  if(file_names.size()<2){
+    PrintUsage();
+    return 1;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  // inputs, all with the schema of the first one
+  std::vector<ColumnarReader> inputs(file_names.size()-1);
+  for(std::size_t i=0;i<inputs.size();i++){
+    auto& input = inputs[i];
+    if(!input.Open(file_names[i+1])){
+      std::cerr << file_names[i+1] << ": " << input.GetError() << std::endl;
+      return 1;
+    }
+    bool same_schema = (input.GetTotalColumns()==inputs[0].GetTotalColumns());
+    for(std::uint32_t column=0;same_schema && column<input.GetTotalColumns();column++){
+      same_schema = (input.GetColumnName(column)==inputs[0].GetColumnName(column)
+          && input.GetColumnType(column)==inputs[0].GetColumnType(column));
+    }
+    if(!same_schema){
+      std::cerr << file_names[i+1] << ": columns differ from " << file_names[1] << std::endl;
+      return 1;
+    }
+  }
+
+  // schema header
+  std::vector<char> header(Columnar::kMagic,Columnar::kMagic+sizeof(Columnar::kMagic));
+  AppendValue(header,Columnar::kVersion);
+  AppendValue(header,inputs[0].GetTotalColumns());
+  for(std::uint32_t column=0;column<inputs[0].GetTotalColumns();column++){
+    const auto& name = inputs[0].GetColumnName(column);
+    AppendValue(header,(std::uint32_t)inputs[0].GetColumnType(column));
+    AppendValue(header,(std::uint32_t)name.size());
+    header.insert(header.end(),name.begin(),name.end());
+  }
+  header.resize(Padded(header.size()),0);
+
+  // place of the blocks in the output
+  std::vector<MergedBlock> blocks;
+  std::uint64_t offset = header.size();
+  std::uint64_t total_rows = 0;
+  std::uint64_t total_bytes = 0;
+  for(const auto& input: inputs){
+    for(const auto& block: input.GetBlocks()){
+      MergedBlock merged = { input.GetStoredData(block), block };
+      merged.block.first_row += total_rows;
+      merged.block.offset = offset;
+      offset += Padded(block.stored_size);
+      total_bytes += block.stored_size;
+      blocks.push_back(merged);
+    }
+    total_rows += input.GetTotalRows();
+  }
+
+  // footer index
+  std::vector<char> footer;
+  auto footer_offset = offset;
+  AppendValue(footer,total_rows);
+  AppendValue(footer,(std::uint64_t)blocks.size());
+  for(const auto& merged: blocks) AppendValue(footer,merged.block);
+  AppendValue(footer,footer_offset);
+  footer.insert(footer.end(),Columnar::kMagic,Columnar::kMagic+sizeof(Columnar::kMagic));
+
+  auto fd = open(file_names[0].c_str(),O_WRONLY|O_CREAT|O_TRUNC,0644);
+  if(fd<0){
+    std::cerr << file_names[0] << ": cannot be created" << std::endl;
+    return 1;
+  }
+  // the padding between the blocks is left as a hole (zeros)
+  bool success = (ftruncate(fd,footer_offset+footer.size())==0)
+    && WriteAt(fd,header.data(),header.size(),0);
+
+  // blocks, interleaved between the threads
+  total_threads = std::min<std::size_t>(total_threads,std::max<std::size_t>(blocks.size(),1));
+  std::vector<char> thread_success(total_threads,1);
+  std::vector<std::thread> threads;
+  for(unsigned int i_thread=0;i_thread<total_threads;i_thread++){
+    threads.emplace_back([&,i_thread](){
+        for(std::size_t i=i_thread;i<blocks.size();i+=total_threads){
+          const auto& merged = blocks[i];
+          if(!WriteAt(fd,merged.data,merged.block.stored_size,merged.block.offset)){
+            thread_success[i_thread] = 0;
+            return;
+          }
+        }
+      });
+  }
+  for(auto& thread: threads) thread.join();
+
+  success = success
+    && std::all_of(thread_success.begin(),thread_success.end(),[](char ok){ return ok!=0; })
+    && WriteAt(fd,footer.data(),footer.size(),footer_offset);
+  success = (close(fd)==0) && success;
+  if(!success){
+    std::cerr << file_names[0] << ": write error" << std::endl;
+    return 1;
+  }
+
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+  std::cout << "merged " << inputs.size() << " files, " << total_rows << " rows, "
+            << blocks.size() << " blocks into " << file_names[0]
+            << " with " << total_threads << " threads" << std::endl;
+  std::cout << "elapsed " << elapsed << " s, "
+            << (elapsed>0. ? total_bytes/elapsed/1.e6 : 0.) << " MB/s" << std::endl;
+  return 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
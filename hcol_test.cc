@@ -0,0 +1,223 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file hcol_test.cc
+/// \brief Round trip and robustness test of the columnar event file
+
+// Usage: hcol_test [directory]
+//
+// Writes columnar files with every codec built in, reads them back and
+// compares the values; checks that truncated or corrupted files are
+// rejected by ColumnarReader::Open and that a failed write is reported
+// by ColumnarWriter::Close. Returns 0 on success.
+
+#include "ColumnarReader.hh"
+#include "ColumnarWriter.hh"
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+  int total_failures = 0;
+
+  void Check(const bool condition, const std::string& test)
+  {
+    if(condition) return;
+    std::cerr << "FAILED: " << test << std::endl;
+    total_failures++;
+  }
+
+  std::vector<char> ReadFile(const std::string& file_name)
+  {
+    std::ifstream file(file_name.c_str(),std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>());
+  }
+
+  void WriteFile(const std::string& file_name, const std::vector<char>& data)
+  {
+    std::ofstream file(file_name.c_str(),std::ios::binary|std::ios::trunc);
+    file.write(data.data(),data.size());
+  }
+
+  // 10 rows: an int column, a float column and a vector (count + values)
+  bool WriteSample(ColumnarWriter& writer, const std::string& file_name)
+  {
+    writer.ClearColumns();
+    writer.DefineColumn("event_id",Columnar::kInt32);
+    writer.DefineColumn("energy",Columnar::kFloat32);
+    writer.DefineColumn("nseg",Columnar::kInt32);
+    writer.DefineColumn("segment_id",Columnar::kInt32);
+    writer.SetChunkRows(3);
+    if(!writer.Open(file_name)) return false;
+    for(std::int32_t row=0; row<10; row++){
+      float energy = 0.5f*row;
+      std::int32_t total_segments = row%4;
+      std::vector<std::int32_t> segments;
+      for(std::int32_t i=0; i<total_segments; i++) segments.push_back(100*row+i);
+      writer.Fill(0,&row,1);
+      writer.Fill(1,&energy,1);
+      writer.Fill(2,&total_segments,1);
+      writer.Fill(3,segments.data(),segments.size());
+      writer.EndRow();
+    }
+    return writer.Close();
+  }
+
+  void CheckSample(const std::string& file_name, const std::string& test)
+  {
+    ColumnarReader reader;
+    Check(reader.Open(file_name),test+": open ("+reader.GetError()+")");
+    if(!reader.IsOpen()) return;
+    Check(reader.GetTotalRows()==10,test+": number of rows");
+    Check(reader.GetTotalColumns()==4,test+": number of columns");
+    Check(reader.FindColumn("segment_id")==3,test+": column name");
+    Check(reader.GetColumnType(1)==Columnar::kFloat32,test+": column type");
+
+    std::vector<std::int32_t> event_id, total_segments, segment_id;
+    std::vector<float> energy;
+    Check(reader.ReadColumn(0,event_id) && reader.ReadColumn(1,energy) &&
+        reader.ReadColumn(2,total_segments) && reader.ReadColumn(3,segment_id),
+        test+": read columns");
+    auto values_ok = event_id.size()==10 && energy.size()==10 && total_segments.size()==10;
+    size_t i_segment = 0;
+    for(std::int32_t row=0; values_ok && row<10; row++){
+      values_ok = event_id[row]==row && energy[row]==0.5f*row && total_segments[row]==row%4;
+      for(std::int32_t i=0; values_ok && i<row%4; i++, i_segment++){
+        values_ok = i_segment<segment_id.size() && segment_id[i_segment]==100*row+i;
+      }
+    }
+    Check(values_ok && i_segment==segment_id.size(),test+": values");
+  }
+
+  void CheckRejected(const std::string& file_name, const std::vector<char>& data,
+      const std::string& test)
+  {
+    WriteFile(file_name,data);
+    ColumnarReader reader;
+    Check(!reader.Open(file_name) && !reader.GetError().empty(),test+": rejected");
+  }
+
+  template <class T>
+  void SetValue(std::vector<char>& data, const size_t offset, const T& value)
+  {
+    std::memcpy(data.data()+offset,&value,sizeof(T));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  std::string directory = argc>1 ? argv[1] : ".";
+  auto file_name = directory+"/hcol_test.hcol";
+
+  // round trip with every codec built in
+  const Columnar::ColumnCodec codecs[]
+    = { Columnar::kNone, Columnar::kLZ4, Columnar::kZstd, Columnar::kZlib };
+  const char* codec_names[] = { "none", "lz4", "zstd", "zlib" };
+  for(auto i_codec=0; i_codec<4; i_codec++){
+    if(!ColumnarWriter::IsCodecAvailable(codecs[i_codec])) continue;
+    std::string test = std::string("round trip (")+codec_names[i_codec]+")";
+    ColumnarWriter writer;
+    writer.SetCodec(codecs[i_codec]);
+    Check(WriteSample(writer,file_name),test+": write");
+    CheckSample(file_name,test);
+  }
+
+  // corrupted files
+  ColumnarWriter writer;
+  Check(WriteSample(writer,file_name),"corruption: write");
+  auto data = ReadFile(file_name);
+  auto corrupted_name = directory+"/hcol_test_corrupted.hcol";
+  const auto footer_pointer = data.size()-sizeof(Columnar::kMagic)-sizeof(std::uint64_t);
+  std::uint64_t footer_offset;
+  std::memcpy(&footer_offset,data.data()+footer_pointer,sizeof(footer_offset));
+  const auto first_block = footer_offset+2*sizeof(std::uint64_t);
+
+  // magics and a footer offset far beyond the end of the file
+  std::vector<char> crafted(48,0);
+  std::memcpy(crafted.data(),Columnar::kMagic,sizeof(Columnar::kMagic));
+  SetValue<std::uint32_t>(crafted,8,Columnar::kVersion);
+  SetValue<std::uint64_t>(crafted,crafted.size()-16,0xfffffff0);
+  std::memcpy(crafted.data()+crafted.size()-8,Columnar::kMagic,sizeof(Columnar::kMagic));
+  CheckRejected(corrupted_name,crafted,"footer offset");
+
+  auto truncated = data;
+  truncated.resize(data.size()/2);
+  CheckRejected(corrupted_name,truncated,"truncated file");
+
+  auto corrupted = data;
+  SetValue<std::uint32_t>(corrupted,12,0xffffffff);
+  CheckRejected(corrupted_name,corrupted,"number of columns");
+
+  corrupted = data;
+  SetValue<std::uint32_t>(corrupted,20,0xfffffff0);
+  CheckRejected(corrupted_name,corrupted,"column name length");
+
+  corrupted = data;
+  SetValue<std::uint64_t>(corrupted,footer_offset+sizeof(std::uint64_t),
+      0x0fffffffffffffffULL);
+  CheckRejected(corrupted_name,corrupted,"number of blocks");
+
+  corrupted = data;
+  SetValue<std::uint32_t>(corrupted,first_block+offsetof(Columnar::ColumnBlock,column),4);
+  CheckRejected(corrupted_name,corrupted,"block column");
+
+  corrupted = data;
+  SetValue<std::uint64_t>(corrupted,first_block+offsetof(Columnar::ColumnBlock,offset),
+      0xfffffffffffffff8ULL);
+  CheckRejected(corrupted_name,corrupted,"block offset");
+
+  corrupted = data;
+  SetValue<std::uint64_t>(corrupted,first_block+offsetof(Columnar::ColumnBlock,stored_size),
+      footer_offset);
+  CheckRejected(corrupted_name,corrupted,"block size");
+
+  // write error (full device)
+  if(access("/dev/full",W_OK)==0){
+    ColumnarWriter full_writer;
+    full_writer.SetChunkRows(1);
+    Check(!WriteSample(full_writer,"/dev/full"),"write error reported");
+  }
+
+  unlink(file_name.c_str());
+  unlink(corrupted_name.c_str());
+
+  if(total_failures>0){
+    std::cerr << total_failures << " test(s) failed" << std::endl;
+    return 1;
+  }
+  std::cout << "hcol_test: all tests passed" << std::endl;
+  return 0;
+}
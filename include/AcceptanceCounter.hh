@@ -0,0 +1,102 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file AcceptanceCounter.hh
+/// \brief Definition of the AcceptanceCounter class
+
+#ifndef AcceptanceCounter_h
+#define AcceptanceCounter_h 1
+
+#include "Constants.hh"
+
+#include "G4VAccumulable.hh"
+#include "globals.hh"
+
+#include <array>
+#include <vector>
+
+class G4GenericMessenger;
+
+/// Acceptance counters
+///
+/// Accumulable (G4AccumulableManager) counting the thrown events per hit
+/// pattern: bit i for the hodoscope i, bit Hodoscope::kTotalNumber+j for
+/// the tracking plane j. The counts of the workers are merged by the
+/// accumulable manager; the master prints the acceptance of every
+/// detector, of the coincidences and of every hit pattern, with their
+/// Wilson score and Clopper-Pearson intervals at
+/// /hodoscope/acceptance/confidenceLevel (68.27% by default).
+///
+/// The reported coincidences are derived from the merged pattern counts:
+/// the one of all the hodoscopes (cdh&disc), and the ones added with
+/// /hodoscope/acceptance/addCoincidence (e.g. cdh+dcin). The commands are
+/// defined by the counter of the master only (not broadcast), the
+/// counters of the workers only count.
+///
+/// The events are counted before the event filter, so the acceptances
+/// do not depend on the skimming.
+
+class AcceptanceCounter : public G4VAccumulable
+{
+  public:
+    static constexpr G4int kTotalDetectors
+      = Hodoscope::kTotalNumber+TrackingPlane::kTotalNumber;
+    static constexpr G4int kTotalPatterns = 1<<kTotalDetectors;
+
+    AcceptanceCounter();
+    virtual ~AcceptanceCounter();
+
+    inline void CountEvent(const G4int pattern) { pattern_counts_[pattern]++; }
+
+    virtual void Merge(const G4VAccumulable& other);
+    virtual void Reset();
+
+    void Print() const;
+
+    // name of the detector of the bit i_detector of the patterns
+    static const G4String& GetDetectorName(const G4int i_detector);
+
+  private:
+    void DefineCommands();
+    void AddCoincidence(const G4String& detectors);
+    G4long GetTotalEvents() const;
+    // events with all the bits of the mask
+    G4long GetTotalEvents(const G4int mask) const;
+    void PrintAcceptance(const G4String& name, const G4long accepted,
+                         const G4long thrown) const;
+
+    std::array<G4long, kTotalPatterns> pattern_counts_;
+    G4double confidence_level_;
+    // reported coincidences (master)
+    std::vector<G4int> coincidence_masks_;
+    std::vector<G4String> coincidence_names_;
+
+    G4GenericMessenger* messenger_;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
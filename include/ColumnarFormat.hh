@@ -0,0 +1,79 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ColumnarFormat.hh
+/// \brief Definition of the columnar event file format
+
+#ifndef ColumnarFormat_h
+#define ColumnarFormat_h 1
+
+#include <cstdint>
+
+/// Native columnar event file (.hcol)
+///
+/// The file can be read back with mmap, without ROOT nor Geant4
+/// (ColumnarReader). The values are stored in the byte order of the
+/// writing machine (little-endian on the supported platforms).
+///
+/// - header : magic "HODOCOL1", format version (uint32), number of
+///            columns (uint32), then per column its type (uint32,
+///            ColumnType) and its name (uint32 length + characters),
+///            padded to 8 bytes
+/// - blocks : the rows are written in chunks; each chunk has one block
+///            per column, starting on an 8-byte boundary, stored raw or
+///            compressed (ColumnCodec)
+/// - footer : number of rows (uint64), number of blocks (uint64), one
+///            ColumnBlock per block, then the offset of the footer
+///            (uint64) and the magic again
+///
+/// Vector quantities are stored as a count column (one entry per row)
+/// and a flat value column (the entries of all rows, in row order).
+
+namespace Columnar {
+  const char kMagic[8] = {'H','O','D','O','C','O','L','1'};
+  const std::uint32_t kVersion = 1;
+
+  enum ColumnType : std::uint32_t { kInt32 = 0, kFloat32 = 1 };
+  enum ColumnCodec : std::uint32_t { kNone = 0, kLZ4 = 1, kZstd = 2, kZlib = 3 };
+
+  inline std::uint32_t GetTypeSize(const std::uint32_t) { return 4; }
+
+  /// Index entry of a block, as stored in the footer
+  struct ColumnBlock {
+    std::uint32_t column;
+    std::uint32_t codec;
+    std::uint64_t first_row;
+    std::uint64_t total_rows;
+    std::uint64_t total_entries;
+    std::uint64_t offset; // from the start of the file
+    std::uint64_t stored_size; // bytes in the file
+    std::uint64_t raw_size; // bytes once decompressed
+  };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,108 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ColumnarReader.hh
+/// \brief Definition of the ColumnarReader class
+
+#ifndef ColumnarReader_h
+#define ColumnarReader_h 1
+
+#include "ColumnarFormat.hh"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Reader of the columnar event file (see ColumnarFormat.hh)
+///
+/// The file is mapped with mmap: the raw blocks are read in place,
+/// without copy; the compressed blocks are decompressed into a buffer
+/// of the caller. It does not depend on Geant4 nor ROOT.
+///
+/// Open checks the header, the footer and every block against the size
+/// of the file, so that the blocks of GetBlocks can be read safely.
+
+class ColumnarReader
+{
+  public:
+    ColumnarReader();
+    ~ColumnarReader();
+
+    bool Open(const std::string& file_name);
+    void Close();
+    inline bool IsOpen() const { return data_!=nullptr; }
+    inline const std::string& GetError() const { return error_; }
+
+    inline std::uint64_t GetTotalRows() const { return total_rows_; }
+    inline std::uint32_t GetTotalColumns() const { return names_.size(); }
+    inline const std::string& GetColumnName(const std::uint32_t column) const { return names_[column]; }
+    inline Columnar::ColumnType GetColumnType(const std::uint32_t column) const { return types_[column]; }
+    // -1 if there is no such column
+    int FindColumn(const std::string& name) const;
+
+    // blocks of all the columns, in file order
+    inline const std::vector<Columnar::ColumnBlock>& GetBlocks() const { return blocks_; }
+    // raw bytes of a block as stored in the file
+    inline const char* GetStoredData(const Columnar::ColumnBlock& block) const { return data_+block.offset; }
+    // values of a block: in place if raw, else decompressed into buffer
+    // (nullptr if the codec is not built in)
+    const char* GetBlockData(const Columnar::ColumnBlock& block, std::vector<char>& buffer) const;
+
+    // all the values of a column, e.g. for small files and tests
+    template <class T> bool ReadColumn(const std::uint32_t column, std::vector<T>& values) const;
+
+  private:
+    // closes the file, sets the error and returns false
+    bool Fail(const std::string& error);
+
+    const char* data_;
+    size_t size_;
+    std::string error_;
+
+    std::vector<std::string> names_;
+    std::vector<Columnar::ColumnType> types_;
+    std::vector<Columnar::ColumnBlock> blocks_;
+    std::uint64_t total_rows_;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+template <class T>
+bool ColumnarReader::ReadColumn(const std::uint32_t column, std::vector<T>& values) const
+{
+  values.clear();
+  std::vector<char> buffer;
+  for(const auto& block: blocks_){
+    if(block.column!=column) continue;
+    auto block_data = GetBlockData(block,buffer);
+    if(!block_data) return false;
+    auto first = reinterpret_cast<const T*>(block_data);
+    values.insert(values.end(),first,first+block.raw_size/sizeof(T));
+  }
+  return true;
+}
+
+#endif
@@ -0,0 +1,149 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ColumnarWriter.hh
+/// \brief Definition of the ColumnarWriter class
+
+#ifndef ColumnarWriter_h
+#define ColumnarWriter_h 1
+
+#include "ColumnarFormat.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/// Writer of the columnar event file (see ColumnarFormat.hh)
+///
+/// The columns are defined before Open(). The values of a row are
+/// appended with Fill() and the row is closed with EndRow(); every
+/// chunk of rows is written as one block per column, compressed with
+/// the selected codec when it was built in (WITH_LZ4, WITH_ZSTD,
+/// WITH_ZLIB) and when it saves space; the level 0 selects the default
+/// level of the codec. Close() writes the footer index.
+///
+/// Open(), Close() and EndRow() return false once a write to the file
+/// has failed (e.g. full disk): the file is then incomplete.
+///
+/// It does not depend on Geant4, so that the standalone tools can use it.
+
+class ColumnarWriter
+{
+  public:
+    ColumnarWriter();
+    ~ColumnarWriter();
+
+    // returns the index of the column
+    std::uint32_t DefineColumn(const std::string& name, const Columnar::ColumnType type);
+    void ClearColumns();
+
+    // false if the codec is not built in (then no compression)
+    bool SetCodec(const Columnar::ColumnCodec codec, const int level = 0);
+    inline void SetChunkRows(const std::uint64_t rows) { chunk_rows_ = rows>0 ? rows : 1; }
+
+    bool Open(const std::string& file_name);
+    // false if any write failed since Open()
+    bool Close();
+    inline bool IsOpen() const { return file_.is_open(); }
+
+    inline void Fill(const std::uint32_t column, const std::int32_t* values, const size_t n);
+    inline void Fill(const std::uint32_t column, const float* values, const size_t n);
+    // false if the chunk written by this row failed
+    inline bool EndRow();
+
+    inline std::uint64_t GetTotalRows() const { return total_rows_; }
+    inline std::uint64_t GetRawBytes() const { return raw_bytes_; }
+    inline std::uint64_t GetStoredBytes() const { return stored_bytes_; }
+    // time spent in the compression of the blocks
+    inline double GetCompressSeconds() const { return compress_seconds_; }
+
+    static bool IsCodecAvailable(const Columnar::ColumnCodec codec);
+
+  private:
+    struct Column {
+      std::string name;
+      Columnar::ColumnType type;
+      std::vector<char> buffer; // values of the current chunk
+      std::uint64_t total_entries;
+    };
+
+    inline void Append(const std::uint32_t column, const void* values, const size_t bytes);
+    bool FlushChunk();
+    bool WriteBlock(const std::uint32_t column, Column& data);
+    void Pad();
+
+    std::vector<Column> columns_;
+    std::vector<Columnar::ColumnBlock> blocks_;
+    std::vector<char> compressed_;
+    std::ofstream file_;
+    std::uint64_t offset_;
+
+    Columnar::ColumnCodec codec_;
+    int level_;
+    std::uint64_t chunk_rows_;
+    std::uint64_t chunk_first_row_;
+    std::uint64_t total_rows_;
+    std::uint64_t raw_bytes_;
+    std::uint64_t stored_bytes_;
+    double compress_seconds_;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void ColumnarWriter::Append(const std::uint32_t column, const void* values,
+    const size_t bytes)
+{
+  auto& buffer = columns_[column].buffer;
+  auto size = buffer.size();
+  buffer.resize(size+bytes);
+  std::copy(static_cast<const char*>(values),static_cast<const char*>(values)+bytes,
+      buffer.data()+size);
+}
+
+inline void ColumnarWriter::Fill(const std::uint32_t column, const std::int32_t* values,
+    const size_t n)
+{
+  Append(column,values,n*sizeof(std::int32_t));
+  columns_[column].total_entries += n;
+}
+
+inline void ColumnarWriter::Fill(const std::uint32_t column, const float* values,
+    const size_t n)
+{
+  Append(column,values,n*sizeof(float));
+  columns_[column].total_entries += n;
+}
+
+inline bool ColumnarWriter::EndRow()
+{
+  total_rows_++;
+  if(total_rows_-chunk_first_row_>=chunk_rows_) return FlushChunk();
+  return true;
+}
+
+#endif
@@ -40,7 +40,16 @@ using std::array;
 namespace Hodoscope{
   constexpr G4int kTotalNumber = 2;
   const array<G4String, kTotalNumber> detector_name
-    = {{ "hodoscope1", "hodoscope2" }};
+    = {{ "cdh", "disc" }};
+}
+
+// virtual tracking planes of the parallel world
+namespace TrackingPlane{
+  constexpr G4int kTotalNumber = 2;
+  enum { kDCINId = 0, kDCOUTId = 1 };
+  const array<G4String, kTotalNumber> detector_name
+    = {{ "dcin", "dcout" }};
+  const G4String world_name = "tracking_plane_world";
 }
 
 namespace MyColour{
@@ -0,0 +1,125 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ConvergenceMonitor.hh
+/// \brief Definition of the ConvergenceMonitor class
+
+#ifndef ConvergenceMonitor_h
+#define ConvergenceMonitor_h 1
+
+#include "AcceptanceCounter.hh"
+
+#include "G4Threading.hh"
+#include "globals.hh"
+
+#include <atomic>
+#include <vector>
+
+class G4GenericMessenger;
+
+/// Convergence-driven termination of the runs
+///
+/// With /hodoscope/convergence/target > 0, the run stops as soon as the
+/// relative uncertainty sqrt((1-p)/(n p)) of the selected acceptances p
+/// (n thrown events) is below the target; /run/beamOn then only gives the
+/// maximum number of events. The selection (/hodoscope/convergence/select)
+/// is a detector, the coincidence of the hodoscopes, or all of them (every
+/// detector and the coincidence must converge).
+///
+/// The threads count the hit pattern of their events in their own slot of
+/// an array of atomic counters (relaxed increments). Every kCheckInterval
+/// events of a thread, the slots are summed and a shared atomic flag is
+/// raised on convergence; the threads check the flag at the end of each
+/// event and abort the run softly (the events in flight are completed).
+/// At least /hodoscope/convergence/minEvents events are processed.
+
+class ConvergenceMonitor
+{
+  public:
+    static ConvergenceMonitor* Instance();
+    ~ConvergenceMonitor();
+
+    // master thread
+    void Reset();
+    void Print() const;
+
+    // every thread, once per event; returns true when the run has converged
+    inline G4bool CountEvent(const G4int pattern);
+
+  private:
+    ConvergenceMonitor();
+
+    void DefineCommands();
+    void SetSelection(const G4String& selection);
+    void Check();
+    // largest relative uncertainty of the selected acceptances
+    G4double GetRelativeUncertainty(G4long& total_events) const;
+
+    static ConvergenceMonitor* instance_;
+
+    static constexpr G4int kCheckInterval = 100;
+
+    // one set of pattern counters per thread (the sequential thread uses
+    // the first one), on their own cache lines
+    static constexpr G4int kMaxThreads = 256;
+    struct Counter {
+      std::atomic<G4long> pattern_counts[AcceptanceCounter::kTotalPatterns];
+      char padding[64];
+    };
+    Counter counters_[kMaxThreads];
+
+    std::atomic<G4bool> converged_;
+
+    G4double target_;
+    G4long min_events_;
+    G4String selection_;
+    // masks of the selected acceptances
+    std::vector<G4int> masks_;
+
+    G4GenericMessenger* messenger_;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline G4bool ConvergenceMonitor::CountEvent(const G4int pattern)
+{
+  if(target_<=0.) return false;
+
+  auto i_thread = G4Threading::G4GetThreadId();
+  if(i_thread<0) i_thread = 0;
+  if(i_thread>=kMaxThreads) i_thread = kMaxThreads-1;
+  auto& counter = counters_[i_thread];
+  counter.pattern_counts[pattern].fetch_add(1,std::memory_order_relaxed);
+
+  if(converged_.load(std::memory_order_relaxed)) return true;
+
+  // count of this thread, checked every kCheckInterval events
+  static G4ThreadLocal G4long total_counted = 0;
+  if(++total_counted%kCheckInterval==0) Check();
+  return converged_.load(std::memory_order_relaxed);
+}
+
+#endif
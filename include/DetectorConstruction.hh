@@ -69,6 +69,7 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     static G4ThreadLocal SolenoidMagneticField* magnetic_field_;
     static G4ThreadLocal G4FieldManager* field_manager_;
     
+    G4VPhysicalVolume* world_physical_;
     G4LogicalVolume* magnetic_logical_;
     G4LogicalVolume* cdh_logical_;
     G4LogicalVolume* disc_logical_;
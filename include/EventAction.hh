@@ -31,6 +31,8 @@
 #define EventAction_h 1
 
 #include "Constants.hh"
+#include "EventRecord.hh"
+#include "EventFilter.hh"
 
 #include "G4UserEventAction.hh"
 #include "globals.hh"
@@ -38,7 +40,23 @@
 #include <vector>
 #include <array>
 
+class AcceptanceCounter;
+
 /// Event action
+///
+/// The per-segment summaries of the hodoscopes are written to vector
+/// columns of the event tree, one set per Hodoscope::detector_name.
+/// The vectors are owned by this class and bound to the ntuple by
+/// RunAction; they are refilled in a single pass over each hits
+/// collection.
+///
+/// When the asynchronous EventWriter is open, the record of the event is
+/// moved to its queue instead of being added as a row of the event tree.
+///
+/// Only the events accepted by the EventFilter are written: the filter is
+/// evaluated from the hit counts and energy deposits, before the vector
+/// columns are filled. Every event is counted by its hit pattern in the
+/// AcceptanceCounter of RunAction before the filter.
 
 class EventAction : public G4UserEventAction
 {
@@ -49,9 +67,31 @@ public:
     virtual void BeginOfEventAction(const G4Event*);
     virtual void EndOfEventAction(const G4Event*);
 
+    inline HodoscopeColumns& GetHodoscopeColumns(const G4int i_hodoscope) 
+    { return record_.hodoscopes[i_hodoscope]; }
+    inline EventFilter& GetEventFilter() { return filter_; }
+    // first of the run_id, event_id and seed columns (booked by RunAction)
+    inline void SetIdColumn(const G4int id_column) { id_column_ = id_column; }
+    // hit pattern counters (owned by RunAction)
+    inline void SetAcceptanceCounter(AcceptanceCounter* acceptance)
+    { acceptance_ = acceptance; }
+
 private:
     // hit collections Ids
     std::array<G4int, Hodoscope::kTotalNumber> hodoscope_hitscollection_id_;
+
+    // per-hodoscope summary of the current event
+    std::array<G4int, Hodoscope::kTotalNumber> hodoscope_total_segments_;
+    std::array<G4double, Hodoscope::kTotalNumber> hodoscope_energy_deposit_;
+
+    // output record of the current event (its vectors are the ntuple columns)
+    EventRecord record_;
+    EventFilter filter_;
+    G4int id_column_;
+    AcceptanceCounter* acceptance_;
+
+    // hit collections Ids of the tracking planes
+    std::array<G4int, TrackingPlane::kTotalNumber> tracking_plane_hitscollection_id_;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,95 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file EventFilter.hh
+/// \brief Definition of the EventFilter class
+
+#ifndef EventFilter_h
+#define EventFilter_h 1
+
+#include "Constants.hh"
+
+#include "globals.hh"
+
+#include <array>
+
+class G4GenericMessenger;
+
+/// Event filter (skimming) of the output
+///
+/// Evaluated by EventAction from the hit counts and energy deposits of the
+/// event, before any ntuple or event-record work; rejected events are
+/// not written (the histograms are still filled).
+///
+/// The selection is set with /hodoscope/filter/select:
+/// - all         : every event (default)
+/// - any         : at least one hit in a hodoscope or a tracking plane
+/// - <hodoscope> : at least one hit segment in this hodoscope (cdh, disc)
+/// - coincidence : at least one hit segment in every hodoscope
+///
+/// and /hodoscope/filter/minEnergyDeposit requires in addition a total
+/// energy deposit in the hodoscopes above the given value. A forced event
+/// (e.g. a replayed one) is accepted whatever the selection.
+///
+/// The numbers of processed and written events are counted per thread,
+/// and merged by RunAction.
+
+class EventFilter
+{
+  public:
+    enum Selection { kAll, kAny, kHodoscope, kCoincidence };
+
+    EventFilter();
+    ~EventFilter();
+
+    G4bool Accept(const std::array<G4int, Hodoscope::kTotalNumber>& total_segments,
+                  const std::array<G4double, Hodoscope::kTotalNumber>& energy_deposit,
+                  const G4int total_tracking_plane_hits,
+                  const G4bool force = false);
+
+    // the energy deposits are only needed with a minimum
+    inline G4bool NeedsEnergyDeposit() const { return min_energy_deposit_>0.; }
+
+    inline G4long GetTotalProcessed() const { return total_processed_; }
+    inline G4long GetTotalAccepted() const { return total_accepted_; }
+    inline void ResetStatistics() { total_processed_ = 0; total_accepted_ = 0; }
+
+  private:
+    void DefineCommands();
+    void SetSelection(const G4String& selection);
+
+    G4GenericMessenger* messenger_;
+    Selection selection_;
+    G4int hodoscope_id_; // with kHodoscope
+    G4double min_energy_deposit_;
+
+    G4long total_processed_;
+    G4long total_accepted_;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
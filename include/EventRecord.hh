@@ -0,0 +1,105 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file EventRecord.hh
+/// \brief Definition of the EventRecord class
+
+#ifndef EventRecord_h
+#define EventRecord_h 1
+
+#include "globals.hh"
+#include "Constants.hh"
+
+#include <array>
+#include <vector>
+
+/// Per-segment columns of a hodoscope, one entry per hit segment
+/// (energy in MeV, time in ns, position in mm)
+
+struct HodoscopeColumns
+{
+  inline void Clear()
+  {
+    segment_id.clear();
+    energy_deposit.clear();
+    time.clear();
+    position_x.clear();
+    position_y.clear();
+    position_z.clear();
+  }
+
+  std::vector<G4int> segment_id;
+  std::vector<G4float> energy_deposit;
+  std::vector<G4float> time;
+  std::vector<G4float> position_x;
+  std::vector<G4float> position_y;
+  std::vector<G4float> position_z;
+};
+
+/// First hit of a tracking plane (position in mm, momentum in MeV/c)
+
+struct TrackingPlaneColumns
+{
+  TrackingPlaneColumns()
+  : total_hits(0), position_x(0.f), position_y(0.f), position_z(0.f),
+    momentum_x(0.f), momentum_y(0.f), momentum_z(0.f) {}
+
+  G4int total_hits;
+  G4float position_x;
+  G4float position_y;
+  G4float position_z;
+  G4float momentum_x;
+  G4float momentum_y;
+  G4float momentum_z;
+};
+
+/// Output record of one event
+///
+/// It holds the same quantities as a row of the event tree. It is
+/// move-only: the event action moves it to the EventWriter queue, so
+/// the vectors are handed over without copy, and gets back a drained
+/// record of the writer with the capacity of its vectors.
+
+class EventRecord
+{
+  public:
+    EventRecord() : run_id(-1), event_id(-1), seed(-1) {}
+    EventRecord(EventRecord&&) = default;
+    EventRecord& operator=(EventRecord&&) = default;
+
+    EventRecord(const EventRecord&) = delete;
+    EventRecord& operator=(const EventRecord&) = delete;
+
+    G4int run_id;
+    G4int event_id;
+    G4int seed; // the event is reproduced from (seed, run_id, event_id)
+    std::array<TrackingPlaneColumns, TrackingPlane::kTotalNumber> tracking_planes;
+    std::array<HodoscopeColumns, Hodoscope::kTotalNumber> hodoscopes;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,154 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file EventRecordQueue.hh
+/// \brief Definition of the EventRecordQueue class
+
+#ifndef EventRecordQueue_h
+#define EventRecordQueue_h 1
+
+#include "EventRecord.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/// Bounded lock-free queue of event records, many producers and many
+/// consumers: the worker threads push to the queue of the writer thread,
+/// which pushes the drained records to a free list popped by the workers
+///
+/// Each cell carries a sequence number telling whether it is free for
+/// the producer of a given position or filled for the consumer of that
+/// position (D. Vyukov's bounded queue). TryPush() and TryPop() never
+/// block and return false when the queue is full or empty. The capacity
+/// is rounded up to a power of two.
+
+class EventRecordQueue
+{
+  public:
+    explicit EventRecordQueue(const size_t capacity);
+    ~EventRecordQueue() {}
+
+    // the record is moved into the queue on success only
+    inline G4bool TryPush(EventRecord& record);
+    // the record is move-assigned from the queue on success only
+    inline G4bool TryPop(EventRecord& record);
+
+    inline size_t GetCapacity() const { return mask_+1; }
+    // approximate number of queued records
+    inline size_t GetDepth() const;
+
+  private:
+    struct Cell {
+      std::atomic<size_t> sequence;
+      EventRecord record;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    // producer and consumer positions on separate cache lines
+    // (padding, the queue is heap allocated without over-alignment)
+    char padding0_[64];
+    std::atomic<size_t> enqueue_position_;
+    char padding1_[64];
+    std::atomic<size_t> dequeue_position_;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline EventRecordQueue::EventRecordQueue(const size_t capacity)
+: mask_(0), enqueue_position_(0), dequeue_position_(0)
+{
+  size_t size = 2;
+  while(size<capacity) size <<= 1;
+  cells_.reset(new Cell[size]);
+  mask_ = size-1;
+  for(size_t i=0; i<size; i++){
+    cells_[i].sequence.store(i,std::memory_order_relaxed);
+  }
+}
+
+inline G4bool EventRecordQueue::TryPush(EventRecord& record)
+{
+  auto position = enqueue_position_.load(std::memory_order_relaxed);
+  for(;;){
+    auto& cell = cells_[position & mask_];
+    auto sequence = cell.sequence.load(std::memory_order_acquire);
+    auto difference = (std::intptr_t)sequence - (std::intptr_t)position;
+    if(difference==0){
+      // the cell is free: claim the position
+      if(enqueue_position_.compare_exchange_weak(position,position+1,
+            std::memory_order_relaxed)){
+        cell.record = std::move(record);
+        cell.sequence.store(position+1,std::memory_order_release);
+        return true;
+      }
+    }
+    else if(difference<0){
+      // the cell of the previous lap is not consumed yet: full
+      return false;
+    }
+    else{
+      position = enqueue_position_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+inline G4bool EventRecordQueue::TryPop(EventRecord& record)
+{
+  auto position = dequeue_position_.load(std::memory_order_relaxed);
+  for(;;){
+    auto& cell = cells_[position & mask_];
+    auto sequence = cell.sequence.load(std::memory_order_acquire);
+    auto difference = (std::intptr_t)sequence - (std::intptr_t)(position+1);
+    if(difference==0){
+      // the cell is filled: claim the position
+      if(dequeue_position_.compare_exchange_weak(position,position+1,
+            std::memory_order_relaxed)){
+        record = std::move(cell.record);
+        // free the cell for the producers of the next lap
+        cell.sequence.store(position+mask_+1,std::memory_order_release);
+        return true;
+      }
+    }
+    else if(difference<0){
+      // the cell of this lap is not filled yet: empty
+      return false;
+    }
+    else{
+      position = dequeue_position_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+inline size_t EventRecordQueue::GetDepth() const
+{
+  auto enqueue_position = enqueue_position_.load(std::memory_order_relaxed);
+  auto dequeue_position = dequeue_position_.load(std::memory_order_relaxed);
+  return enqueue_position>dequeue_position ? enqueue_position-dequeue_position : 0;
+}
+
+#endif
@@ -0,0 +1,123 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file EventSeeder.hh
+/// \brief Definition of the EventSeeder class
+
+#ifndef EventSeeder_h
+#define EventSeeder_h 1
+
+#include "globals.hh"
+
+class G4GenericMessenger;
+
+/// Per-event seeding of the random engine
+///
+/// At the start of every event (PrimaryGeneratorAction), the engine of the
+/// thread is reseeded from (seed, run ID, event ID) only: any event can
+/// be reproduced from these three numbers, without stored engine states,
+/// and the results do not depend on the number of threads nor on the
+/// scheduling of the events.
+///
+/// With the MixMax engine (the default), the triple selects one of the
+/// independent MixMax streams (seed_uniquestream); other engines are
+/// seeded with a 64-bit hash of the triple (and the luxury level for
+/// Ranlux).
+///
+/// The engine is selected with /hodoscope/random/engine (mixmax, ranlux,
+/// ranlux64, mtwist, ranecu, james) and /hodoscope/random/luxury (Ranlux
+/// engines, -1: default level). Every thread installs it at the start of
+/// a run (RunAction): the workers of G4MTRunManager otherwise clone the
+/// engine of the master as it was when the run manager was created.
+///
+/// The seed of the job is set with /hodoscope/random/seed; when it is not
+/// set, it is drawn from std::random_device (jobs started from the same
+/// macro are independent) and printed at every run to reproduce the job.
+/// /hodoscope/random/perEventSeeding false restores the seeding of the
+/// workers by the master engine.
+///
+/// /hodoscope/replay <run> <event> re-simulates one event of a previous
+/// job (same seed, from the run_id, event_id and seed columns of the
+/// output) in a run of one event: the engine is seeded with the recorded
+/// IDs, the hodoscopes record every step, the event bypasses the event
+/// filter and is written with its original IDs to replay_run<run>_event<event>
+/// (g4root and columnar outputs), and drawn when the visualization is
+/// enabled. The tracking verbosity of the replay is set with
+/// /hodoscope/random/replayVerbose; the detail levels, verbosity and file
+/// names of the job are left unchanged.
+
+class EventSeeder
+{
+  public:
+    static EventSeeder* Instance();
+    ~EventSeeder();
+
+    enum Engine { kMixMax, kRanlux, kRanlux64, kMTwist, kRanecu, kJames };
+
+    // every thread, at the start of a run
+    void InstallEngine() const;
+    // every thread, at the start of an event
+    void SeedEvent(const G4int run_id, const G4int event_id) const;
+
+    inline G4int GetSeed() const { return seed_; }
+    inline G4bool GetPerEventSeeding() const { return per_event_seeding_; }
+    void PrintSeeding() const;
+
+    // master thread
+    void Replay(const G4int run_id, const G4int event_id);
+
+    inline G4bool IsReplaying() const { return replaying_; }
+    inline G4int GetReplayRunID() const { return replay_run_id_; }
+    inline G4int GetReplayEventID() const { return replay_event_id_; }
+
+  private:
+    EventSeeder();
+
+    void DefineCommands();
+    void SetSeed(G4int seed);
+    void SetEngine(const G4String& engine);
+    void SeedStream(const G4int run_id, const G4int event_id) const;
+
+    static EventSeeder* instance_;
+
+    G4int seed_;
+    G4bool seed_set_;
+    G4bool per_event_seeding_;
+    Engine engine_;
+    G4int luxury_;
+
+    G4bool replaying_;
+    G4int replay_run_id_;
+    G4int replay_event_id_;
+    G4int replay_verbose_;
+
+    G4GenericMessenger* messenger_;
+    G4GenericMessenger* replay_messenger_;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
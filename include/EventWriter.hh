@@ -0,0 +1,157 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file EventWriter.hh
+/// \brief Definition of the EventWriter class
+
+#ifndef EventWriter_h
+#define EventWriter_h 1
+
+#include "globals.hh"
+#include "EventRecord.hh"
+#include "ColumnarWriter.hh"
+
+#include <atomic>
+#include <thread>
+
+class EventRecordQueue;
+class G4GenericMessenger;
+
+/// Asynchronous writer of the event records
+///
+/// When enabled with /hodoscope/output/asyncWriter, the event records
+/// are written by a dedicated thread instead of the event tree of the
+/// analysis manager. The worker threads move their records to a bounded
+/// lock-free queue (EventRecordQueue) and only wait when the queue is
+/// full; the writer thread drains it to <fileName>_run<run ID>.hcol,
+/// a columnar file (ColumnarWriter) readable with mmap without ROOT.
+/// The drained records go back to the workers through a small free list,
+/// so that the vectors of their records keep their capacity.
+///
+/// The writer is shared by all threads. It is opened and closed by the
+/// master run action; the back-pressure statistics (queue depth, stalls
+/// of the workers on a full queue, writer busy time) are printed at the
+/// end of each run. A columnar file whose writing failed (e.g. full disk)
+/// raises a warning at its close and is reported as incomplete.
+///
+/// With /hodoscope/output/perWorkerFiles, there is no queue nor writer
+/// thread: each worker writes its own file <fileName>_run<ID>_t<thread>.hcol
+/// from its thread (the blocks are written every chunkRows events) and
+/// closes it at its end of run; the g4root ntuple is not merged through
+/// the master either (one file per worker). The columnar files of the
+/// workers are concatenated by the hcol_merge tool.
+///
+/// The columns follow the event tree: run_id, event_id, seed, for each tracking
+/// plane <name>_nhit and the position and momentum of the first hit, and
+/// for each hodoscope <name>_nseg (count column) and the per-segment
+/// <name>_segment_id, _energy_deposit, _time and _position_x/y/z.
+/// The codec of the blocks is selected with /hodoscope/output/codec and
+/// codecLevel; the compression of the g4root file (applied by RunAction
+/// on every thread) with rootCodec and rootCodecLevel.
+
+class EventWriter
+{
+  public:
+    static EventWriter* Instance();
+    ~EventWriter();
+
+    // master thread
+    void Open(const G4int run_id);
+    void Close();
+    void PrintStatistics() const;
+
+    inline G4bool IsEnabled() const { return enabled_; }
+    inline G4bool IsOpen() const { return running_.load(std::memory_order_acquire); }
+    inline G4bool GetPerWorkerFiles() const { return per_worker_files_; }
+    inline const G4String& GetFileName() const { return file_name_; }
+    // compression level of the g4root file (0: none, zlib otherwise)
+    inline G4int GetRootCompressionLevel() const { return root_codec_level_; }
+
+    // worker threads: move the record to the queue, wait if it is full,
+    // and replace it with a drained record of the free list (keeping the
+    // capacity of its vectors); or write it to the file of the worker
+    void Push(EventRecord& record);
+    // worker threads, end of run (per-worker files)
+    void CloseWorkerFile();
+
+  private:
+    EventWriter();
+
+    void DefineCommands();
+    void SetPerWorkerFiles(G4bool per_worker_files);
+    void SetCodec(const G4String& codec);
+    void SetRootCodec(const G4String& codec);
+    void OpenFile(ColumnarWriter& file, const G4String& file_name);
+    void Run();
+    void Write(ColumnarWriter& file, const EventRecord& record);
+    // failed close of a columnar file
+    void ReportWriteError();
+
+    static EventWriter* instance_;
+
+    G4bool enabled_;
+    G4int queue_size_;
+    G4String file_name_;
+    Columnar::ColumnCodec codec_;
+    G4int codec_level_;
+    G4int chunk_rows_;
+    G4int root_codec_level_;
+    G4bool per_worker_files_;
+    G4int run_id_;
+
+    EventRecordQueue* queue_;
+    // records drained by the writer thread, reused by the workers
+    static constexpr G4int kFreeRecords = 64;
+    EventRecordQueue* free_records_;
+    std::thread thread_;
+    std::atomic<G4bool> running_;
+    ColumnarWriter file_;
+
+    // filled by the worker threads
+    std::atomic<G4long> total_pushed_;
+    std::atomic<G4long> total_stalls_;
+    std::atomic<G4long> stall_nanoseconds_;
+    std::atomic<G4long> depth_sum_;
+    std::atomic<G4long> max_depth_;
+    std::atomic<G4long> total_recycled_;
+    // per-worker files: time spent by the workers in Write(), of which
+    // in the compression, and bytes of their files
+    std::atomic<G4long> write_nanoseconds_;
+    std::atomic<G4long> compress_nanoseconds_;
+    std::atomic<G4long> raw_bytes_;
+    std::atomic<G4long> stored_bytes_;
+    // filled by the writer thread, read after it is joined
+    // (by the workers with per-worker files)
+    std::atomic<G4long> total_written_;
+    std::atomic<G4int> total_failed_files_;
+    G4double busy_seconds_;
+
+    G4GenericMessenger* messenger_;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -38,6 +38,8 @@
 #include "G4Transform3D.hh"
 #include "G4RotationMatrix.hh"
 
+#include "HodoscopeStepStore.hh"
+
 #include <vector>
 
 class G4AttDef;
@@ -45,12 +47,23 @@ class G4AttValue;
 
 using std::vector;
 
-/// Drift chamber hit
+/// Hodoscope hit
 ///
 /// It records:
-/// - the layer ID
-/// - the particle time
-/// - the particle local and global positions
+/// - the segment ID, its logical volume and placement
+/// - the steps deposited in the segment (track, parent and particle IDs,
+///   time, energy deposit, local and global entry positions, exit position,
+///   momentum, polarization)
+///
+/// The step data are not owned by the hit: they are rows of the
+/// HodoscopeStepStore of the hits collection, chained from first_row_.
+///
+/// Get*() without index return a HodoscopeStepView on the rows of the
+/// hit, without copy. The views are available once the store has been
+/// compacted by HodoscopeSD::EndOfEvent, i.e. in the end-of-event
+/// action, digitizers and Draw(). Get*(i_hit) check the index.
+/// The element types of the views depend on the store layout
+/// (HodoscopeStepReal and HodoscopeStepVector, double precision by default).
 
 class HodoscopeHit : public G4VHit
 {
@@ -82,76 +95,126 @@ class HodoscopeHit : public G4VHit
     inline void SetRotation(const G4RotationMatrix rotation) { rotation_ = rotation; }
     inline G4RotationMatrix GetRotation() const { return rotation_; }
 
-    inline void PushTotalHits() { total_hits_++; }
-    inline void SetTotalHits(const G4int total_hits) { total_hits_ = total_hits; }
+    inline void SetStepStore(HodoscopeStepStore* store) { step_store_ = store; }
+    inline HodoscopeStepStore* GetStepStore() const { return step_store_; }
+
     inline G4int GetTotalHits() const { return total_hits_; }
 
-    inline void PushTrackID(const G4int id) { track_id_.push_back(id); }
+    // running summary of all the steps, including unrecorded ones.
+    // returns true if the step starts a new track in the segment
+    inline G4bool AccumulateStep(const G4int track_id, const G4double de,
+        const G4double time, const G4ThreeVector& global_position);
+    inline G4double GetTotalEnergyDeposit() const { return total_energy_deposit_; }
+    inline G4double GetFirstHitTime() const { return first_hit_time_; }
+    inline G4int GetMultiplicity() const { return multiplicity_; }
+    inline G4ThreeVector GetWeightedPosition() const;
+
+    inline void PushStep(const G4int track_id, const G4int parent_id, const G4int particle_id,
+        const G4double hit_time, const G4double energy_deposit,
+        const G4ThreeVector& local_position, const G4ThreeVector& global_position,
+        const G4ThreeVector& exit_position,
+        const G4ThreeVector& momentum, const G4ThreeVector& polarization);
+
+    // true if a step of the track is in the store (walks the steps)
+    inline G4bool HasTrack(const G4int track_id) const;
+
+    // merge a step of the same track into the last step:
+    // the energy deposit is added and the exit position moved
+    inline void MergeLastStep(const G4double energy_deposit, const G4ThreeVector& exit_position);
+
+    // copy the rows of this hit contiguously (see HodoscopeStepStore::CompactChain)
+    inline void Compact();
+
     inline void SetTrackID(const G4int i_hit, const G4int id);
-    inline vector<G4int> GetTrackID() const { return track_id_; }
+    inline HodoscopeStepView<G4int> GetTrackID() const { return GetView(step_store_->GetTrackIDData()); }
     inline G4int GetTrackID(const G4int i_hit) const;
 
-    inline void PushParentID(const G4int id) { parent_id_.push_back(id); }
     inline void SetParentID(const G4int i_hit, const G4int id);
-    inline vector<G4int> GetParentID() const { return parent_id_; }
+    inline HodoscopeStepView<G4int> GetParentID() const { return GetView(step_store_->GetParentIDData()); }
     inline G4int GetParentID(const G4int i_hit) const;
 
-    inline void PushParticleID(const G4int id) { particle_id_.push_back(id); }
     inline void SetParticleID(const G4int i_hit, const G4int id);
-    inline vector<G4int> GetParticleID() const { return particle_id_; }
+    inline HodoscopeStepView<G4int> GetParticleID() const { return GetView(step_store_->GetParticleIDData()); }
     inline G4int GetParticleID(const G4int i_hit) const;
 
-    inline void PushHitTime(const G4double time) { hit_time_.push_back(time); }
     inline void SetHitTime(const G4int i_hit, G4double time);
-    inline vector<G4double> GetHitTime() const { return hit_time_; }
+    inline HodoscopeStepView<HodoscopeStepReal> GetHitTime() const { return GetView(step_store_->GetHitTimeData()); }
     inline G4double GetHitTime(const G4int i_hit) const;
 
-    inline void PushEnergyDeposit(const G4double de) { energy_deposit_.push_back(de); }
     inline void SetEnergyDeposit(const G4int i_hit, const G4double de);
-    inline vector<G4double> GetEnergyDeposit() const { return energy_deposit_; }
+    inline HodoscopeStepView<HodoscopeStepReal> GetEnergyDeposit() const { return GetView(step_store_->GetEnergyDepositData()); }
     inline G4double GetEnergyDeposit(const G4int i_hit) const;
 
-    inline void PushLocalPosition(const G4ThreeVector position) { local_position_.push_back(position); }
     inline void SetLocalPosition(const G4int i_hit, const G4ThreeVector position);
-    inline vector<G4ThreeVector> GetLocalPosition() const { return local_position_; }
+    inline HodoscopeStepView<HodoscopeStepVector> GetLocalPosition() const { return GetView(step_store_->GetLocalPositionData()); }
     inline G4ThreeVector GetLocalPosition(const G4int i_hit) const;
 
-    inline void PushGlobalPosition(const G4ThreeVector position) { global_position_.push_back(position); }
     inline void SetGlobalPosition(const G4int i_hit, const G4ThreeVector position);
-    inline vector<G4ThreeVector> GetGlobalPosition() const { return global_position_; }
+    inline HodoscopeStepView<HodoscopeStepVector> GetGlobalPosition() const { return GetView(step_store_->GetGlobalPositionData()); }
     inline G4ThreeVector GetGlobalPosition(const G4int i_hit) const;
 
-    inline void PushMomentum(const G4ThreeVector momentum) { momentum_.push_back(momentum); }
+    inline void SetExitPosition(const G4int i_hit, const G4ThreeVector position);
+    inline HodoscopeStepView<HodoscopeStepVector> GetExitPosition() const { return GetView(step_store_->GetExitPositionData()); }
+    inline G4ThreeVector GetExitPosition(const G4int i_hit) const;
+
     inline void SetMomentum(const G4int i_hit, const G4ThreeVector momentum);
-    inline vector<G4ThreeVector> GetMomentum() const { return momentum_; }
+    inline HodoscopeStepView<HodoscopeStepVector> GetMomentum() const { return GetView(step_store_->GetMomentumData()); }
     inline G4ThreeVector GetMomentum(const G4int i_hit) const;
 
-    inline void PushPolarization(const G4ThreeVector polarization) { polarization_.push_back(polarization); }
     inline void SetPolarization(const G4int i_hit, const G4ThreeVector polarization);
-    inline vector<G4ThreeVector> GetPolarization() const { return polarization_; }
+    inline HodoscopeStepView<HodoscopeStepVector> GetPolarization() const { return GetView(step_store_->GetPolarizationData()); }
     inline G4ThreeVector GetPolarization(const G4int i_hit) const;
 
   private:
+    // row of the i-th step in the store, -1 if out of range
+    inline G4int GetRow(const G4int i_hit) const;
+    // rows of this hit in a column of the compacted store
+    template <class T> inline HodoscopeStepView<T> GetView(const T* column) const;
+
     G4int segment_id_;
     G4LogicalVolume* logical_;
     G4ThreeVector position_;
     G4RotationMatrix rotation_;
     G4int total_hits_;
-
-    vector<G4int> track_id_;
-    vector<G4int> parent_id_;
-    vector<G4int> particle_id_;
-    vector<G4double> hit_time_;
-    vector<G4double> energy_deposit_;
-    vector<G4ThreeVector> local_position_;
-    vector<G4ThreeVector> global_position_;
-    vector<G4ThreeVector> momentum_;
-    vector<G4ThreeVector> polarization_;
+    G4double total_energy_deposit_;
+    G4double first_hit_time_;
+    G4int multiplicity_; // number of tracks entering the segment
+    G4int last_track_id_;
+    G4ThreeVector weighted_position_sum_; // sum of energy deposit * position
+
+    HodoscopeStepStore* step_store_;
+    G4int first_row_;
+    G4int last_row_;
+    // energy deposit of the last row in double precision (sum of the
+    // merged steps), the reference of the single-precision loss
+    G4double last_energy_deposit_;
 };
 
-using HodoscopeHitsCollection = G4THitsCollection<HodoscopeHit>;
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+/// Hodoscope hits collection
+///
+/// It owns the step store shared by its hits. The store is taken from
+/// and given back to the thread-local pool of HodoscopeStepStore, so
+/// a kept event (e.g. for visualization) keeps its step data.
+
+class HodoscopeHitsCollection : public G4THitsCollection<HodoscopeHit>
+{
+  public:
+    HodoscopeHitsCollection(G4String detector_name, G4String collection_name);
+    virtual ~HodoscopeHitsCollection();
+
+    inline void *operator new(size_t);
+    inline void operator delete(void *aHC);
+
+    inline HodoscopeStepStore* GetStepStore() const { return step_store_; }
+
+  private:
+    HodoscopeStepStore* step_store_;
+};
 
 extern G4ThreadLocal G4Allocator<HodoscopeHit>* HodoscopeHitAllocator;
+extern G4ThreadLocal G4Allocator<HodoscopeHitsCollection>* HodoscopeHitsCollectionAllocator;
 
 inline void* HodoscopeHit::operator new(size_t)
 {
@@ -166,9 +229,107 @@ inline void HodoscopeHit::operator delete(void* aHit)
   HodoscopeHitAllocator->FreeSingle((HodoscopeHit*) aHit);
 }
 
+inline void* HodoscopeHitsCollection::operator new(size_t)
+{
+  if (!HodoscopeHitsCollectionAllocator) {
+    HodoscopeHitsCollectionAllocator = new G4Allocator<HodoscopeHitsCollection>;
+  }
+  return (void*)HodoscopeHitsCollectionAllocator->MallocSingle();
+}
+
+inline void HodoscopeHitsCollection::operator delete(void* aHC)
+{
+  HodoscopeHitsCollectionAllocator->FreeSingle((HodoscopeHitsCollection*) aHC);
+}
+
+inline void HodoscopeHit::PushStep(const G4int track_id, const G4int parent_id, const G4int particle_id,
+    const G4double hit_time, const G4double energy_deposit,
+    const G4ThreeVector& local_position, const G4ThreeVector& global_position,
+    const G4ThreeVector& exit_position,
+    const G4ThreeVector& momentum, const G4ThreeVector& polarization)
+{
+  last_row_ = step_store_->PushStep(last_row_,
+      track_id, parent_id, particle_id, hit_time, energy_deposit,
+      local_position, global_position, exit_position, momentum, polarization);
+  if(first_row_<0) first_row_ = last_row_;
+  last_energy_deposit_ = energy_deposit;
+  total_hits_++;
+}
+
+inline G4bool HodoscopeHit::AccumulateStep(const G4int track_id, const G4double de,
+    const G4double time, const G4ThreeVector& global_position)
+{
+  if(multiplicity_==0 || time<first_hit_time_) first_hit_time_ = time;
+  total_energy_deposit_ += de;
+  weighted_position_sum_ += de*global_position;
+
+  if(track_id==last_track_id_) return false;
+  last_track_id_ = track_id;
+  multiplicity_++;
+  return true;
+}
+
+inline G4ThreeVector HodoscopeHit::GetWeightedPosition() const
+{
+  if(total_energy_deposit_<=0.) return G4ThreeVector(0);
+  return weighted_position_sum_/total_energy_deposit_;
+}
+
+inline G4bool HodoscopeHit::HasTrack(const G4int track_id) const
+{
+  for(auto row=first_row_; row>=0; row=step_store_->GetNextRow(row)){
+    if(step_store_->GetTrackID(row)==track_id) return true;
+  }
+  return false;
+}
+
+inline void HodoscopeHit::MergeLastStep(const G4double energy_deposit, const G4ThreeVector& exit_position)
+{
+  step_store_->SetEnergyDeposit(last_row_,
+      step_store_->GetEnergyDeposit(last_row_)+energy_deposit);
+  step_store_->SetExitPosition(last_row_,exit_position);
+  last_energy_deposit_ += energy_deposit;
+#ifdef COMPACT_HODOSCOPE_STEPS
+  // the single-precision sum rounds at every merged step
+  step_store_->AccumulateEnergyDepositLoss(last_row_,last_energy_deposit_);
+#endif
+}
+
+inline void HodoscopeHit::Compact()
+{
+  if(first_row_<0) return;
+  first_row_ = step_store_->CompactChain(first_row_);
+  last_row_ = first_row_+total_hits_-1;
+}
+
+inline G4int HodoscopeHit::GetRow(const G4int i_hit) const
+{
+  if(i_hit<0 || i_hit>=total_hits_) return -1;
+  if(step_store_->IsCompacted()) return first_row_+i_hit;
+
+  auto row = first_row_;
+  for(auto i=0; i<i_hit; i++) row = step_store_->GetNextRow(row);
+  return row;
+}
+
+template <class T>
+inline HodoscopeStepView<T> HodoscopeHit::GetView(const T* column) const
+{
+  if(first_row_<0) return HodoscopeStepView<T>();
+  if(!step_store_->IsCompacted()){
+    G4ExceptionDescription msg;
+    msg << "Steps are not contiguous before the end of event." << G4endl; 
+    G4Exception("HodoscopeHit::GetView()",
+        "Code002", JustWarning, msg);
+    return HodoscopeStepView<T>();
+  }
+  return HodoscopeStepView<T>(column+first_row_,total_hits_);
+}
+
 inline void HodoscopeHit::SetTrackID(const G4int i_hit, const G4int id){
-  if(i_hit<total_hits_){
-    track_id_[i_hit] = id;
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    step_store_->SetTrackID(row,id);
   }
   else{
     G4ExceptionDescription msg;
@@ -178,8 +339,9 @@ inline void HodoscopeHit::SetTrackID(const G4int i_hit, const G4int id){
   }
 }
 inline G4int HodoscopeHit::GetTrackID(const G4int i_hit) const{
-  if(i_hit<total_hits_){
-    return track_id_[i_hit];
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    return step_store_->GetTrackID(row);
   }
   else{
     G4ExceptionDescription msg;
@@ -191,8 +353,9 @@ inline G4int HodoscopeHit::GetTrackID(const G4int i_hit) const{
 }
 
 inline void HodoscopeHit::SetParentID(const G4int i_hit, const G4int id){
-  if(i_hit<total_hits_){
-    parent_id_[i_hit] = id;
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    step_store_->SetParentID(row,id);
   }
   else{
     G4ExceptionDescription msg;
@@ -202,8 +365,9 @@ inline void HodoscopeHit::SetParentID(const G4int i_hit, const G4int id){
   }
 }
 inline G4int HodoscopeHit::GetParentID(const G4int i_hit) const{
-  if(i_hit<total_hits_){
-    return parent_id_[i_hit];
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    return step_store_->GetParentID(row);
   }
   else{
     G4ExceptionDescription msg;
@@ -215,8 +379,9 @@ inline G4int HodoscopeHit::GetParentID(const G4int i_hit) const{
 }
 
 inline void HodoscopeHit::SetParticleID(const G4int i_hit, const G4int id){
-  if(i_hit<total_hits_){
-    parent_id_[i_hit] = id;
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    step_store_->SetParticleID(row,id);
   }
   else{
     G4ExceptionDescription msg;
@@ -226,8 +391,9 @@ inline void HodoscopeHit::SetParticleID(const G4int i_hit, const G4int id){
   }
 }
 inline G4int HodoscopeHit::GetParticleID(const G4int i_hit) const{
-  if(i_hit<total_hits_){
-    return particle_id_[i_hit];
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    return step_store_->GetParticleID(row);
   }
   else{
     G4ExceptionDescription msg;
@@ -239,8 +405,9 @@ inline G4int HodoscopeHit::GetParticleID(const G4int i_hit) const{
 }
 
 inline void HodoscopeHit::SetHitTime(const G4int i_hit, const G4double hit_time){
-  if(i_hit<total_hits_){
-    hit_time_[i_hit] = hit_time;
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    step_store_->SetHitTime(row,hit_time);
   }
   else{
     G4ExceptionDescription msg;
@@ -250,8 +417,9 @@ inline void HodoscopeHit::SetHitTime(const G4int i_hit, const G4double hit_time)
   }
 }
 inline G4double HodoscopeHit::GetHitTime(const G4int i_hit) const{
-  if(i_hit<total_hits_){
-    return hit_time_[i_hit];
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    return step_store_->GetHitTime(row);
   }
   else{
     G4ExceptionDescription msg;
@@ -263,8 +431,9 @@ inline G4double HodoscopeHit::GetHitTime(const G4int i_hit) const{
 }
 
 inline void HodoscopeHit::SetEnergyDeposit(const G4int i_hit, const G4double energy_deposit){
-  if(i_hit<total_hits_){
-    energy_deposit_[i_hit] = energy_deposit;
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    step_store_->SetEnergyDeposit(row,energy_deposit);
   }
   else{
     G4ExceptionDescription msg;
@@ -274,8 +443,9 @@ inline void HodoscopeHit::SetEnergyDeposit(const G4int i_hit, const G4double ene
   }
 }
 inline G4double HodoscopeHit::GetEnergyDeposit(const G4int i_hit) const{
-  if(i_hit<total_hits_){
-    return energy_deposit_[i_hit];
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    return step_store_->GetEnergyDeposit(row);
   }
   else{
     G4ExceptionDescription msg;
@@ -287,8 +457,9 @@ inline G4double HodoscopeHit::GetEnergyDeposit(const G4int i_hit) const{
 }
 
 inline void HodoscopeHit::SetLocalPosition(const G4int i_hit, const G4ThreeVector local_position){
-  if(i_hit<total_hits_){
-    local_position_[i_hit] = local_position;
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    step_store_->SetLocalPosition(row,local_position);
   }
   else{
     G4ExceptionDescription msg;
@@ -298,8 +469,9 @@ inline void HodoscopeHit::SetLocalPosition(const G4int i_hit, const G4ThreeVecto
   }
 }
 inline G4ThreeVector HodoscopeHit::GetLocalPosition(const G4int i_hit) const{
-  if(i_hit<total_hits_){
-    return local_position_[i_hit];
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    return step_store_->GetLocalPosition(row);
   }
   else{
     G4ExceptionDescription msg;
@@ -311,8 +483,9 @@ inline G4ThreeVector HodoscopeHit::GetLocalPosition(const G4int i_hit) const{
 }
 
 inline void HodoscopeHit::SetGlobalPosition(const G4int i_hit, const G4ThreeVector global_position){
-  if(i_hit<total_hits_){
-    global_position_[i_hit] = global_position;
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    step_store_->SetGlobalPosition(row,global_position);
   }
   else{
     G4ExceptionDescription msg;
@@ -322,8 +495,9 @@ inline void HodoscopeHit::SetGlobalPosition(const G4int i_hit, const G4ThreeVect
   }
 }
 inline G4ThreeVector HodoscopeHit::GetGlobalPosition(const G4int i_hit) const{
-  if(i_hit<total_hits_){
-    return global_position_[i_hit];
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    return step_store_->GetGlobalPosition(row);
   }
   else{
     G4ExceptionDescription msg;
@@ -334,9 +508,36 @@ inline G4ThreeVector HodoscopeHit::GetGlobalPosition(const G4int i_hit) const{
   }
 }
 
+inline void HodoscopeHit::SetExitPosition(const G4int i_hit, const G4ThreeVector exit_position){
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    step_store_->SetExitPosition(row,exit_position);
+  }
+  else{
+    G4ExceptionDescription msg;
+    msg << "No hits found." << G4endl; 
+    G4Exception("HodoscopeHit::SetExitPosition()",
+        "Code002", JustWarning, msg);
+  }
+}
+inline G4ThreeVector HodoscopeHit::GetExitPosition(const G4int i_hit) const{
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    return step_store_->GetExitPosition(row);
+  }
+  else{
+    G4ExceptionDescription msg;
+    msg << "No hits found." << G4endl; 
+    G4Exception("HodoscopeHit::GetExitPosition(G4int)",
+        "Code002", JustWarning, msg);
+    return G4ThreeVector(0);
+  }
+}
+
 inline void HodoscopeHit::SetMomentum(const G4int i_hit, const G4ThreeVector momentum){
-  if(i_hit<total_hits_){
-    momentum_[i_hit] = momentum;
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    step_store_->SetMomentum(row,momentum);
   }
   else{
     G4ExceptionDescription msg;
@@ -346,8 +547,9 @@ inline void HodoscopeHit::SetMomentum(const G4int i_hit, const G4ThreeVector mom
   }
 }
 inline G4ThreeVector HodoscopeHit::GetMomentum(const G4int i_hit) const{
-  if(i_hit<total_hits_){
-    return momentum_[i_hit];
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    return step_store_->GetMomentum(row);
   }
   else{
     G4ExceptionDescription msg;
@@ -359,8 +561,9 @@ inline G4ThreeVector HodoscopeHit::GetMomentum(const G4int i_hit) const{
 }
 
 inline void HodoscopeHit::SetPolarization(const G4int i_hit, const G4ThreeVector polarization){
-  if(i_hit<total_hits_){
-    polarization_[i_hit] = polarization;
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    step_store_->SetPolarization(row,polarization);
   }
   else{
     G4ExceptionDescription msg;
@@ -370,8 +573,9 @@ inline void HodoscopeHit::SetPolarization(const G4int i_hit, const G4ThreeVector
   }
 }
 inline G4ThreeVector HodoscopeHit::GetPolarization(const G4int i_hit) const{
-  if(i_hit<total_hits_){
-    return polarization_[i_hit];
+  auto row = GetRow(i_hit);
+  if(row>=0){
+    return step_store_->GetPolarization(row);
   }
   else{
     G4ExceptionDescription msg;
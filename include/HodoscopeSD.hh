@@ -31,14 +31,50 @@
 #define HodoscopeSD_h 1
 
 #include "G4VSensitiveDetector.hh"
+#include "G4AffineTransform.hh"
+#include "G4RotationMatrix.hh"
+#include "G4ThreeVector.hh"
 
 #include "HodoscopeHit.hh"
 
+#include <vector>
+
 class G4Step;
 class G4HCofThisEvent;
 class G4TouchableHistory;
+class G4GenericMessenger;
+class G4VPhysicalVolume;
+class G4LogicalVolume;
+class G4VTouchable;
 
-/// Drift chamber sensitive detector
+/// Hodoscope sensitive detector
+///
+/// The recording level is selected with /hodoscope/sd/<name>/detail:
+/// - summary : running summary per segment (HodoscopeHit::AccumulateStep)
+///             only, no step
+/// - track   : one merged step per track and segment, without local
+///             position and polarization
+/// - step    : every step with all the quantities (default)
+/// - entry   : one record per track entering a segment (pre-step point on
+///             the geometry boundary), with the entry time, position and
+///             momentum, no energy deposit. The other steps are skipped
+///             before any bookkeeping.
+///
+/// With /hodoscope/sd/<name>/mergeSteps, the consecutive steps of a track
+/// in a segment are merged into one at step level too. The event replayed
+/// by /hodoscope/replay is recorded at step level, without merging.
+///
+/// Steps with an energy deposit not above /hodoscope/sd/<name>/energyThreshold
+/// or starting after /hodoscope/sd/<name>/timeWindow (global time) are
+/// dropped before any hit bookkeeping, e.g. late neutron-induced hits.
+/// The energy threshold is not applied at entry level.
+///
+/// The numbers of processed steps and of recorded steps are counted for
+/// the throughput statistics printed by RunAction.
+///
+/// The transforms of the segments are cached by copy number, from the
+/// geometry with CacheSegmentPlacements() or on the first hit of a segment,
+/// so that no touchable history is used for the following steps.
 
 class HodoscopeSD : public G4VSensitiveDetector
 {
@@ -48,10 +84,72 @@ class HodoscopeSD : public G4VSensitiveDetector
     
     virtual void Initialize(G4HCofThisEvent*HCE);
     virtual G4bool ProcessHits(G4Step* aStep, G4TouchableHistory* ROhist);
+    virtual void EndOfEvent(G4HCofThisEvent*HCE);
+
+    enum DetailLevel { kSummary, kTrack, kStep, kEntry };
+
+    void SetDetailLevel(const G4String& level);
+    inline DetailLevel GetDetailLevel() const { return detail_level_; }
+
+    inline void SetMergeSteps(const G4bool merge_steps) { merge_steps_ = merge_steps; }
+    inline G4bool GetMergeSteps() const { return merge_steps_; }
+
+    inline void SetEnergyThreshold(const G4double threshold) { energy_threshold_ = threshold; }
+    inline G4double GetEnergyThreshold() const { return energy_threshold_; }
+
+    inline void SetTimeWindow(const G4double time_window) { time_window_ = time_window; }
+    inline G4double GetTimeWindow() const { return time_window_; }
+
+    inline G4long GetTotalSteps() const { return total_steps_; }
+    inline G4long GetTotalRecords() const { return total_records_; }
+    inline void ResetStatistics() { total_steps_ = 0; total_records_ = 0; }
+
+    // cache the transforms of the segments placed in the world
+    void CacheSegmentPlacements(const G4VPhysicalVolume* world);
     
   private:
+    struct SegmentPlacement {
+      enum State { kEmpty, kCached, kAmbiguous };
+      SegmentPlacement() : state(kEmpty) {}
+      State state;
+      G4AffineTransform global_to_local;
+      G4ThreeVector position; // local to global
+      G4RotationMatrix rotation; // local to global
+    };
+
+    void DefineCommands();
+    G4bool ProcessEntry(G4Step* step);
+    HodoscopeHit* GetHit(const G4int segment_id, const G4VTouchable* touchable);
+
+    void CacheSegmentPlacements(const G4LogicalVolume* mother,
+        const G4AffineTransform& mother_global_to_local);
+    void SetPlacement(SegmentPlacement& placement,
+        const G4AffineTransform& global_to_local);
+    const SegmentPlacement& GetSegmentPlacement(const G4int segment_id,
+        const G4VTouchable* touchable);
+
     HodoscopeHitsCollection* hits_collection_;
     G4int hits_collection_id_;
+
+    // copy number -> index in hits_collection_ (-1 if the segment has no hit)
+    std::vector<G4int> segment_hit_index_;
+    // copy numbers filled in the current event, used to reset the index
+    std::vector<G4int> hit_segments_;
+    size_t total_segments_high_water_;
+    // copy number -> placement of the segment
+    std::vector<SegmentPlacement> segment_placements_;
+
+    G4GenericMessenger* messenger_;
+    DetailLevel detail_level_;
+    G4bool merge_steps_;
+    // levels of the current event (step level in a replay, see EventSeeder)
+    DetailLevel event_detail_level_;
+    G4bool event_merge_steps_;
+    G4double energy_threshold_; // steps with edep <= threshold are dropped
+    G4double time_window_; // steps starting later (global time) are dropped
+
+    G4long total_steps_; // steps given to ProcessHits
+    G4long total_records_; // steps pushed to the step store
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
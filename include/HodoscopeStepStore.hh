@@ -0,0 +1,293 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file HodoscopeStepStore.hh
+/// \brief Definition of the HodoscopeStepStore class
+
+#ifndef HodoscopeStepStore_h
+#define HodoscopeStepStore_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <vector>
+
+/// Single-precision three-vector of the compact step store
+///
+/// It converts to and from G4ThreeVector.
+
+class HodoscopeFloat3
+{
+  public:
+    HodoscopeFloat3() : x_(0.f), y_(0.f), z_(0.f) {}
+    HodoscopeFloat3(const G4ThreeVector& v) : x_(v.x()), y_(v.y()), z_(v.z()) {}
+
+    inline G4double x() const { return x_; }
+    inline G4double y() const { return y_; }
+    inline G4double z() const { return z_; }
+    inline operator G4ThreeVector() const { return G4ThreeVector(x_,y_,z_); }
+
+  private:
+    G4float x_;
+    G4float y_;
+    G4float z_;
+};
+
+// Floating-point types of the step store columns (time, energy deposit,
+// positions, momentum and polarization). The compact layout is selected
+// at build time with the WITH_COMPACT_HODOSCOPE_STEPS CMake option.
+#ifdef COMPACT_HODOSCOPE_STEPS
+using HodoscopeStepReal = G4float;
+using HodoscopeStepVector = HodoscopeFloat3;
+#else
+using HodoscopeStepReal = G4double;
+using HodoscopeStepVector = G4ThreeVector;
+#endif
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+/// Read-only view of contiguous rows of a HodoscopeStepStore column
+///
+/// It does not copy the data and does not check the index.
+/// It is valid until the store is released.
+
+template <class T>
+class HodoscopeStepView
+{
+  public:
+    HodoscopeStepView() : data_(nullptr), size_(0) {}
+    HodoscopeStepView(const T* data, const G4int size) : data_(data), size_(size) {}
+
+    inline const T* begin() const { return data_; }
+    inline const T* end() const { return data_+size_; }
+    inline const T* data() const { return data_; }
+    inline G4int size() const { return size_; }
+    inline G4bool empty() const { return size_==0; }
+    inline const T& operator[](const G4int i) const { return data_[i]; }
+
+  private:
+    const T* data_;
+    G4int size_;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+/// Column-wise step storage shared by all hits of a hodoscope
+///
+/// Every field of a step is stored in its own contiguous column.
+/// While an event is processed, the rows of a hit are chained with
+/// the next-row column. Compact() reorders the rows at the end of the
+/// event so that the rows of each hit become contiguous.
+///
+/// With the compact layout, the floating-point columns are stored in
+/// single precision and the precision loss against double precision is
+/// accumulated on each push of a step and on each merge into the last
+/// step of a hit (the energy deposit summed in single precision against
+/// the double sum), and reported by PrintStatistics().
+///
+/// Compaction is needed only if a row was appended to a chain whose last
+/// row is not the previous row of the store (interleaved hits); otherwise
+/// the chains are already contiguous and IsCompacted() stays true.
+///
+/// Stores are recycled through a thread-local pool with Acquire() and
+/// Release(): the columns are cleared, not freed, between events.
+/// Acquired stores are reserved to the largest number of rows of the
+/// previous run (high-water mark), and TrimPool() brings the capacity
+/// of the pooled stores back to it at the end of each run, so that a
+/// single large event does not keep its memory for the whole job.
+
+class HodoscopeStepStore
+{
+  public:
+    static HodoscopeStepStore* Acquire();
+    static void Release(HodoscopeStepStore* store);
+    // to be called by each thread at the end of run
+    static void TrimPool();
+    // print and reset the statistics of the stores released by this thread
+    static void PrintStatistics();
+
+    // append a row chained after previous_row (-1 for the first row of a hit)
+    // and return its index
+    inline G4int PushStep(const G4int previous_row,
+        const G4int track_id, const G4int parent_id, const G4int particle_id,
+        const G4double hit_time, const G4double energy_deposit,
+        const G4ThreeVector& local_position, const G4ThreeVector& global_position,
+        const G4ThreeVector& exit_position,
+        const G4ThreeVector& momentum, const G4ThreeVector& polarization);
+
+    // reorder the chained rows so that each chain becomes contiguous
+    void BeginCompaction();
+    G4int CompactChain(const G4int first_row); // returns the new first row
+    void EndCompaction();
+
+    inline G4bool IsCompacted() const { return compacted_; }
+#ifdef COMPACT_HODOSCOPE_STEPS
+    // loss of the energy deposit stored in a row against its double value
+    void AccumulateEnergyDepositLoss(const G4int row,
+        const G4double energy_deposit) const;
+#endif
+    inline G4int GetTotalRows() const { return (G4int)track_id_.size(); }
+    inline G4int GetNextRow(const G4int row) const { return next_row_[row]; }
+
+    // first element of each column, see HodoscopeStepView
+    inline const G4int* GetTrackIDData() const { return track_id_.data(); }
+    inline const G4int* GetParentIDData() const { return parent_id_.data(); }
+    inline const G4int* GetParticleIDData() const { return particle_id_.data(); }
+    inline const HodoscopeStepReal* GetHitTimeData() const { return hit_time_.data(); }
+    inline const HodoscopeStepReal* GetEnergyDepositData() const { return energy_deposit_.data(); }
+    inline const HodoscopeStepVector* GetLocalPositionData() const { return local_position_.data(); }
+    inline const HodoscopeStepVector* GetGlobalPositionData() const { return global_position_.data(); }
+    inline const HodoscopeStepVector* GetExitPositionData() const { return exit_position_.data(); }
+    inline const HodoscopeStepVector* GetMomentumData() const { return momentum_.data(); }
+    inline const HodoscopeStepVector* GetPolarizationData() const { return polarization_.data(); }
+
+    inline G4int GetTrackID(const G4int row) const { return track_id_[row]; }
+    inline void SetTrackID(const G4int row, const G4int id) { track_id_[row] = id; }
+
+    inline G4int GetParentID(const G4int row) const { return parent_id_[row]; }
+    inline void SetParentID(const G4int row, const G4int id) { parent_id_[row] = id; }
+
+    inline G4int GetParticleID(const G4int row) const { return particle_id_[row]; }
+    inline void SetParticleID(const G4int row, const G4int id) { particle_id_[row] = id; }
+
+    inline G4double GetHitTime(const G4int row) const { return hit_time_[row]; }
+    inline void SetHitTime(const G4int row, const G4double time) { hit_time_[row] = time; }
+
+    inline G4double GetEnergyDeposit(const G4int row) const { return energy_deposit_[row]; }
+    inline void SetEnergyDeposit(const G4int row, const G4double de) { energy_deposit_[row] = de; }
+
+    inline G4ThreeVector GetLocalPosition(const G4int row) const { return local_position_[row]; }
+    inline void SetLocalPosition(const G4int row, const G4ThreeVector& position) { local_position_[row] = position; }
+
+    inline G4ThreeVector GetGlobalPosition(const G4int row) const { return global_position_[row]; }
+    inline void SetGlobalPosition(const G4int row, const G4ThreeVector& position) { global_position_[row] = position; }
+
+    inline G4ThreeVector GetExitPosition(const G4int row) const { return exit_position_[row]; }
+    inline void SetExitPosition(const G4int row, const G4ThreeVector& position) { exit_position_[row] = position; }
+
+    inline G4ThreeVector GetMomentum(const G4int row) const { return momentum_[row]; }
+    inline void SetMomentum(const G4int row, const G4ThreeVector& momentum) { momentum_[row] = momentum; }
+
+    inline G4ThreeVector GetPolarization(const G4int row) const { return polarization_[row]; }
+    inline void SetPolarization(const G4int row, const G4ThreeVector& polarization) { polarization_[row] = polarization; }
+
+  private:
+    HodoscopeStepStore();
+    ~HodoscopeStepStore();
+    HodoscopeStepStore(const HodoscopeStepStore&) = delete;
+    HodoscopeStepStore& operator=(const HodoscopeStepStore&) = delete;
+
+    // PushStep without the precision check (compaction copies)
+    inline G4int AppendRow(const G4int previous_row,
+        const G4int track_id, const G4int parent_id, const G4int particle_id,
+        const G4double hit_time, const G4double energy_deposit,
+        const G4ThreeVector& local_position, const G4ThreeVector& global_position,
+        const G4ThreeVector& exit_position,
+        const G4ThreeVector& momentum, const G4ThreeVector& polarization);
+
+    void Clear();
+    void Reserve(const G4int total_rows);
+    void Shrink(const G4int total_rows);
+    void SwapColumns(HodoscopeStepStore& other);
+#ifdef COMPACT_HODOSCOPE_STEPS
+    void AccumulatePrecisionLoss(const G4int row,
+        const G4double hit_time, const G4double energy_deposit,
+        const G4ThreeVector& local_position, const G4ThreeVector& global_position,
+        const G4ThreeVector& momentum) const;
+#endif
+
+    std::vector<G4int> next_row_;
+    std::vector<G4int> track_id_;
+    std::vector<G4int> parent_id_;
+    std::vector<G4int> particle_id_;
+    std::vector<HodoscopeStepReal> hit_time_;
+    std::vector<HodoscopeStepReal> energy_deposit_;
+    std::vector<HodoscopeStepVector> local_position_;
+    std::vector<HodoscopeStepVector> global_position_; // entry (pre-step) position
+    std::vector<HodoscopeStepVector> exit_position_; // post-step position of the last merged step
+    std::vector<HodoscopeStepVector> momentum_;
+    std::vector<HodoscopeStepVector> polarization_;
+
+    G4bool compacted_;
+    G4long reallocations_; // column growths since the store was acquired
+    HodoscopeStepStore* scratch_; // target of the compaction, recycled too
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline G4int HodoscopeStepStore::AppendRow(const G4int previous_row,
+    const G4int track_id, const G4int parent_id, const G4int particle_id,
+    const G4double hit_time, const G4double energy_deposit,
+    const G4ThreeVector& local_position, const G4ThreeVector& global_position,
+    const G4ThreeVector& exit_position,
+    const G4ThreeVector& momentum, const G4ThreeVector& polarization)
+{
+  // all the columns have the same length and grow together
+  if(track_id_.size()==track_id_.capacity()) reallocations_++;
+
+  G4int row = (G4int)track_id_.size();
+  if(previous_row>=0){
+    next_row_[previous_row] = row;
+    // the chain is interleaved with another one
+    if(previous_row!=row-1) compacted_ = false;
+  }
+  next_row_.push_back(-1);
+  track_id_.push_back(track_id);
+  parent_id_.push_back(parent_id);
+  particle_id_.push_back(particle_id);
+  hit_time_.push_back(hit_time);
+  energy_deposit_.push_back(energy_deposit);
+  local_position_.push_back(local_position);
+  global_position_.push_back(global_position);
+  exit_position_.push_back(exit_position);
+  momentum_.push_back(momentum);
+  polarization_.push_back(polarization);
+
+  return row;
+}
+
+inline G4int HodoscopeStepStore::PushStep(const G4int previous_row,
+    const G4int track_id, const G4int parent_id, const G4int particle_id,
+    const G4double hit_time, const G4double energy_deposit,
+    const G4ThreeVector& local_position, const G4ThreeVector& global_position,
+    const G4ThreeVector& exit_position,
+    const G4ThreeVector& momentum, const G4ThreeVector& polarization)
+{
+  auto row = AppendRow(previous_row, track_id, parent_id, particle_id,
+      hit_time, energy_deposit, local_position, global_position,
+      exit_position, momentum, polarization);
+
+#ifdef COMPACT_HODOSCOPE_STEPS
+  AccumulatePrecisionLoss(row, hit_time, energy_deposit,
+      local_position, global_position, momentum);
+#endif
+
+  return row;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -63,6 +63,7 @@ public:
   virtual void ConstructProcess();    
 
   void AddPhysicsList(const G4String& name);
+  void AddParallelWorld(const G4String& world_name);
   void List();
   
 private:
@@ -74,6 +75,7 @@ private:
   G4VPhysicsConstructor*  fEmPhysicsList;
   G4VPhysicsConstructor*  fParticleList;
   std::vector<G4VPhysicsConstructor*>  fHadronPhys;
+  G4VPhysicsConstructor*  fParallelWorldPhys;
     
   PhysicsListMessenger* fMessenger;
   G4PhysListFactoryMessenger* fFactMessenger;
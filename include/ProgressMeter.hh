@@ -0,0 +1,113 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ProgressMeter.hh
+/// \brief Definition of the ProgressMeter class
+
+#ifndef ProgressMeter_h
+#define ProgressMeter_h 1
+
+#include "G4Threading.hh"
+#include "globals.hh"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+class G4GenericMessenger;
+
+/// Progress meter of the runs
+///
+/// The threads count their events in their own slot of an array of
+/// atomic counters (relaxed increment, one cache line per slot), so that
+/// nothing is shared on the event path. A reporter thread started by the
+/// master prints, every /hodoscope/progress/interval seconds of wall
+/// clock, the number of events, the rate over the last interval and
+/// since the start of the run, the mean, minimum and maximum rates of
+/// the threads, the estimated time to the end of the run and the
+/// resident memory of the process.
+///
+/// It replaces the printing on /run/printProgress boundaries; the
+/// interval 0 disables the reports.
+
+class ProgressMeter
+{
+  public:
+    static ProgressMeter* Instance();
+    ~ProgressMeter();
+
+    // master thread
+    void Start(const G4long total_events);
+    void Stop();
+
+    // every thread, once per event
+    inline void CountEvent();
+
+  private:
+    ProgressMeter();
+
+    void DefineCommands();
+    void Run();
+    void Report(const G4double elapsed, const G4double interval);
+    G4long GetTotalCounted() const;
+
+    static ProgressMeter* instance_;
+
+    // one counter per thread (the sequential thread uses the first one)
+    static constexpr G4int kMaxThreads = 256;
+    struct Counter {
+      std::atomic<G4long> total_events;
+      char padding[64-sizeof(std::atomic<G4long>)];
+    };
+    Counter counters_[kMaxThreads];
+    G4long last_counts_[kMaxThreads]; // reporter thread only
+
+    G4double interval_;
+    G4long total_events_;
+    G4long last_total_;
+    std::chrono::steady_clock::time_point start_;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable stop_condition_;
+    G4bool stop_;
+
+    G4GenericMessenger* messenger_;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void ProgressMeter::CountEvent()
+{
+  auto i_thread = G4Threading::G4GetThreadId();
+  if(i_thread<0) i_thread = 0;
+  if(i_thread>=kMaxThreads) i_thread = kMaxThreads-1;
+  counters_[i_thread].total_events.fetch_add(1,std::memory_order_relaxed);
+}
+
+#endif
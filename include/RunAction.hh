@@ -31,22 +31,47 @@
 #define RunAction_h 1
 
 #include "G4UserRunAction.hh"
+#include "AcceptanceCounter.hh"
+#include "EventRecord.hh"
+
+#include "G4Accumulable.hh"
 #include "globals.hh"
 
 class G4Run;
+class G4Timer;
+class EventAction;
 
 /// Run action class
+///
+/// The event tree is booked on every thread: with ntuple merging, the
+/// ntuples of the workers are merged into the one booked by the master.
+/// The hodoscope vector columns are bound to the record of the event
+/// action on the workers (and in sequential mode), to vectors owned by
+/// the run action on the master (which fills no row).
+///
+/// The numbers of processed and written events (EventFilter) of the
+/// workers are merged with accumulables and printed by the master,
+/// as well as the acceptance per detector and per hit pattern
+/// (AcceptanceCounter).
 
 class RunAction : public G4UserRunAction
 {
   public:
-    RunAction();
+    RunAction(EventAction* event_action = nullptr);
     virtual ~RunAction();
 
     virtual void BeginOfRunAction(const G4Run*);
     virtual void   EndOfRunAction(const G4Run*);
 
   private:
+    EventAction* event_action_;
+    G4Timer* timer_;
+    // vector columns of the event tree of the master
+    std::array<HodoscopeColumns, Hodoscope::kTotalNumber> master_columns_;
+
+    G4Accumulable<G4long> total_processed_events_;
+    G4Accumulable<G4long> total_written_events_;
+    AcceptanceCounter acceptance_;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,103 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file StepProfiler.hh
+/// \brief Definition of the StepProfiler class
+
+#ifndef StepProfiler_h
+#define StepProfiler_h 1
+
+#include "globals.hh"
+
+#include <map>
+
+class G4Step;
+class G4Track;
+class G4GenericMessenger;
+
+/// Stepping profiler
+///
+/// Enabled with /hodoscope/profile/enable, it accumulates the number of
+/// steps, the track length and the CPU time of the thread per logical
+/// volume (pre-step point), per particle type and per process limiting
+/// the step. The CPU time between two steps of a track (from the start
+/// of the track for the first one) is charged to the second step.
+///
+/// The tables are filled by SteppingAction and TrackingAction in
+/// thread-local tables keyed by pointer, merged by name into the tables
+/// of this shared instance at the end of run of every thread (RunAction).
+/// The master prints them sorted by CPU time and writes them as JSON to
+/// <fileName>_run<ID>.json.
+
+class StepProfiler
+{
+  public:
+    static StepProfiler* Instance();
+    ~StepProfiler();
+
+    inline G4bool IsEnabled() const { return enabled_; }
+
+    // every thread
+    void BeginOfTrack(const G4Track* track);
+    void Step(const G4Step* step);
+    void Merge();
+
+    // master thread
+    void Reset();
+    void Report(const G4int run_id) const;
+
+    struct Entry {
+      G4long total_steps = 0;
+      G4long total_tracks = 0; // particles only
+      G4double track_length = 0.;
+      G4double cpu_time = 0.; // seconds
+    };
+    using Table = std::map<G4String, Entry>;
+
+  private:
+    StepProfiler();
+
+    void DefineCommands();
+    void PrintTable(const G4String& title, const Table& table, const G4bool with_tracks) const;
+    void WriteTable(std::ostream& file, const G4String& name, const Table& table) const;
+
+    static StepProfiler* instance_;
+
+    G4bool enabled_;
+    G4String file_name_;
+    G4int total_rows_;
+
+    // merged tables
+    Table volumes_;
+    Table particles_;
+    Table processes_;
+
+    G4GenericMessenger* messenger_;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,100 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \copied from B5DriftChamberHit.hh
+/// \brief Definition of the TrackingPlaneHit class
+
+#ifndef TrackingPlaneHit_h
+#define TrackingPlaneHit_h 1
+
+#include "G4VHit.hh"
+#include "G4THitsCollection.hh"
+#include "G4Allocator.hh"
+#include "G4ThreeVector.hh"
+
+/// Tracking plane hit
+///
+/// One crossing of a virtual tracking plane by a track: track and
+/// particle IDs, global time, global position and momentum at the
+/// crossing point.
+
+class TrackingPlaneHit : public G4VHit
+{
+  public:
+    TrackingPlaneHit();
+    TrackingPlaneHit(const TrackingPlaneHit &right);
+    virtual ~TrackingPlaneHit();
+
+    const TrackingPlaneHit& operator=(const TrackingPlaneHit &right);
+    G4bool operator==(const TrackingPlaneHit &right) const;
+
+    inline void *operator new(size_t);
+    inline void operator delete(void *aHit);
+
+    virtual void Draw();
+    virtual void Print();
+
+    inline void SetTrackID(const G4int id) { track_id_ = id; }
+    inline G4int GetTrackID() const { return track_id_; }
+
+    inline void SetParticleID(const G4int id) { particle_id_ = id; }
+    inline G4int GetParticleID() const { return particle_id_; }
+
+    inline void SetHitTime(const G4double time) { hit_time_ = time; }
+    inline G4double GetHitTime() const { return hit_time_; }
+
+    inline void SetGlobalPosition(const G4ThreeVector& position) { global_position_ = position; }
+    inline G4ThreeVector GetGlobalPosition() const { return global_position_; }
+
+    inline void SetMomentum(const G4ThreeVector& momentum) { momentum_ = momentum; }
+    inline G4ThreeVector GetMomentum() const { return momentum_; }
+
+  private:
+    G4int track_id_;
+    G4int particle_id_;
+    G4double hit_time_;
+    G4ThreeVector global_position_;
+    G4ThreeVector momentum_;
+};
+
+using TrackingPlaneHitsCollection = G4THitsCollection<TrackingPlaneHit>;
+
+extern G4ThreadLocal G4Allocator<TrackingPlaneHit>* TrackingPlaneHitAllocator;
+
+inline void* TrackingPlaneHit::operator new(size_t)
+{
+  if (!TrackingPlaneHitAllocator) {
+    TrackingPlaneHitAllocator = new G4Allocator<TrackingPlaneHit>;
+  }
+  return (void*)TrackingPlaneHitAllocator->MallocSingle();
+}
+
+inline void TrackingPlaneHit::operator delete(void* aHit)
+{
+  TrackingPlaneHitAllocator->FreeSingle((TrackingPlaneHit*) aHit);
+}
+
+#endif
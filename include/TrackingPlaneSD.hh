@@ -0,0 +1,63 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \copied from B5DriftChamberSD.hh
+/// \brief Definition of the TrackingPlaneSD class
+
+#ifndef TrackingPlaneSD_h
+#define TrackingPlaneSD_h 1
+
+#include "G4VSensitiveDetector.hh"
+
+#include "TrackingPlaneHit.hh"
+
+class G4Step;
+class G4HCofThisEvent;
+class G4TouchableHistory;
+
+/// Tracking plane sensitive detector
+///
+/// Flux scorer of a massless plane of the tracking plane world: one hit
+/// per track entering the plane through its boundary, the other steps
+/// return without any bookkeeping.
+
+class TrackingPlaneSD : public G4VSensitiveDetector
+{
+  public:
+    TrackingPlaneSD(G4String name);
+    virtual ~TrackingPlaneSD();
+    
+    virtual void Initialize(G4HCofThisEvent*HCE);
+    virtual G4bool ProcessHits(G4Step* aStep, G4TouchableHistory* ROhist);
+    
+  private:
+    TrackingPlaneHitsCollection* hits_collection_;
+    G4int hits_collection_id_;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,63 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file TrackingPlaneWorld.hh
+/// \brief Definition of the TrackingPlaneWorld class
+
+#ifndef TrackingPlaneWorld_h
+#define TrackingPlaneWorld_h 1
+
+#include "G4VUserParallelWorld.hh"
+#include "Constants.hh"
+
+#include <array>
+
+class G4LogicalVolume;
+
+/// Parallel world of the virtual tracking planes
+///
+/// The planes (TrackingPlane::detector_name) are thin cylindrical shells
+/// without material around the beam axis, inside the solenoid. They are
+/// seen only through G4ParallelWorldPhysics, so they add neither material
+/// nor volumes to the navigation of the mass world. Each plane has a
+/// TrackingPlaneSD recording the tracks crossing it.
+
+class TrackingPlaneWorld : public G4VUserParallelWorld
+{
+  public:
+    TrackingPlaneWorld(G4String world_name);
+    virtual ~TrackingPlaneWorld();
+
+    virtual void Construct();
+    virtual void ConstructSD();
+
+  private:
+    std::array<G4LogicalVolume*, TrackingPlane::kTotalNumber> plane_logical_;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
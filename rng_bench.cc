@@ -0,0 +1,109 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file rng_bench.cc
+/// \brief Throughput of the random engines
+
+// Usage: rng_bench [numbers]
+//
+// Prints the random numbers per second and the time per number of the
+// engines selectable with /hodoscope/random/engine, with flat() (one
+// number per call, as most of the Geant4 processes use them) and with
+// flatArray().
+
+#include "CLHEP/Random/MixMaxRng.h"
+#include "CLHEP/Random/RanluxEngine.h"
+#include "CLHEP/Random/Ranlux64Engine.h"
+#include "CLHEP/Random/MTwistEngine.h"
+#include "CLHEP/Random/RanecuEngine.h"
+#include "CLHEP/Random/JamesRandom.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+  void Measure(const std::string& name, CLHEP::HepRandomEngine* engine, const long total_numbers)
+  {
+    std::unique_ptr<CLHEP::HepRandomEngine> owner(engine);
+    using Clock = std::chrono::steady_clock;
+
+    // flat(), summed so that the calls are not optimized away
+    double sum = 0.;
+    auto start = Clock::now();
+    for(long i = 0; i < total_numbers; ++i) sum += engine->flat();
+    auto flat_seconds = std::chrono::duration<double>(Clock::now()-start).count();
+
+    // flatArray()
+    std::vector<double> buffer(1024);
+    start = Clock::now();
+    for(long i = 0; i < total_numbers; i += buffer.size()){
+      engine->flatArray(buffer.size(),buffer.data());
+      sum += buffer[0];
+    }
+    auto array_seconds = std::chrono::duration<double>(Clock::now()-start).count();
+
+    std::cout << std::left << std::setw(12) << name << std::right
+              << std::setw(14) << std::setprecision(4) << total_numbers/flat_seconds
+              << std::setw(12) << 1.e9*flat_seconds/total_numbers
+              << std::setw(14) << total_numbers/array_seconds
+              << std::setw(12) << 1.e9*array_seconds/total_numbers
+              << "   (" << sum << ")" << std::endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc,char** argv)
+{
+  long total_numbers = argc>1 ? std::atol(argv[1]) : 100000000;
+  if(total_numbers<=0){
+    std::cerr << "Usage: rng_bench [numbers]" << std::endl;
+    return 1;
+  }
+
+  const long seed = 12345;
+  std::cout << std::left << std::setw(12) << "engine" << std::right
+            << std::setw(14) << "flat [1/s]" << std::setw(12) << "[ns]"
+            << std::setw(14) << "array [1/s]" << std::setw(12) << "[ns]" << std::endl;
+  Measure("mixmax",new CLHEP::MixMaxRng(seed),total_numbers);
+  for(int luxury = 0; luxury <= 4; ++luxury){
+    Measure("ranlux"+std::to_string(luxury),new CLHEP::RanluxEngine(seed,luxury),total_numbers);
+  }
+  for(int luxury = 0; luxury <= 2; ++luxury){
+    Measure("ranlux64_"+std::to_string(luxury),new CLHEP::Ranlux64Engine(seed,luxury),total_numbers);
+  }
+  Measure("mtwist",new CLHEP::MTwistEngine(seed),total_numbers);
+  Measure("ranecu",new CLHEP::RanecuEngine(),total_numbers);
+  Measure("james",new CLHEP::HepJamesRandom(),total_numbers);
+  return 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
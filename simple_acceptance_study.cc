@@ -28,6 +28,8 @@
 /// \brief Main program of simple_acceptance_study
 
 #include "DetectorConstruction.hh"
+#include "TrackingPlaneWorld.hh"
+#include "Constants.hh"
 #include "ActionInitialization.hh"
 #include "PhysicsList.hh"
 #include "PhysicsListMessenger.hh"
@@ -39,6 +41,8 @@
 #endif
 
 #include "G4UImanager.hh"
+#include "Randomize.hh"
+#include "CLHEP/Random/MixMaxRng.h"
 #include "FTFP_BERT.hh"
 #include "G4StepLimiterPhysics.hh"
 #include "G4PhysListFactory.hh"
@@ -49,15 +53,56 @@
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+namespace {
+  void PrintUsage() {
+    G4cerr << " Usage: " << G4endl;
+    G4cerr << " execute-simple_acceptance_study [macro] [-s seed] [-r run event]" << G4endl;
+    G4cerr << "   -s : seed of the job (/hodoscope/random/seed)" << G4endl;
+    G4cerr << "   -r : replay the event of the given run after the macro" << G4endl;
+    G4cerr << "        (/hodoscope/replay), interactively without macro" << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 int main(int argc,char** argv)
 {
-  // Detect interactive mode (if no arguments) and define UI session
+  // Evaluate arguments
+  //
+  G4String macro;
+  G4String seed;
+  G4String replay;
+  for ( G4int i=1; i<argc; ++i ) {
+    G4String argument = argv[i];
+    if ( argument == "-s" && i+1 < argc ) {
+      seed = argv[++i];
+    }
+    else if ( argument == "-r" && i+2 < argc ) {
+      replay = argv[i+1];
+      replay += " ";
+      replay += argv[i+2];
+      i += 2;
+    }
+    else if ( argument[0] != '-' && macro.empty() ) {
+      macro = argument;
+    }
+    else {
+      PrintUsage();
+      return 1;
+    }
+  }
+
+  // Detect interactive mode (if no macro) and define UI session
   //
   G4UIExecutive* ui = 0;
-  if ( argc == 1 ) {
+  if ( macro.empty() ) {
     ui = new G4UIExecutive(argc, argv);
   }
 
+  // MixMax engine: the events are reseeded with independent streams
+  // (see EventSeeder)
+  G4Random::setTheEngine(new CLHEP::MixMaxRng);
+
   // Construct the default run manager
   //
 #ifdef G4MULTITHREADED
@@ -67,10 +112,14 @@ int main(int argc,char** argv)
 #endif
 
   // Mandatory user initialization classes
-  runManager->SetUserInitialization(new DetectorConstruction);
+  auto detector = new DetectorConstruction;
+  // virtual tracking planes in a parallel world
+  detector->RegisterParallelWorld(new TrackingPlaneWorld(TrackingPlane::world_name));
+  runManager->SetUserInitialization(detector);
 
   auto physicslist = new PhysicsList();
   physicslist->AddPhysicsList("QGSP_BERT_HP");
+  physicslist->AddParallelWorld(TrackingPlane::world_name);
   runManager->SetUserInitialization(physicslist);
 
   // User action initialization
@@ -86,17 +135,27 @@ int main(int argc,char** argv)
   // Get the pointer to the User Interface manager
   auto UImanager = G4UImanager::GetUIpointer();
 
+  if ( !seed.empty() ) {
+    UImanager->ApplyCommand("/hodoscope/random/seed "+seed);
+  }
+
   if ( !ui ) {
     // execute an argument macro file if exist
     G4String command = "/control/execute ";
-    G4String fileName = argv[1];
-    UImanager->ApplyCommand(command+fileName);
+    UImanager->ApplyCommand(command+macro);
+    if ( !replay.empty() ) {
+      UImanager->ApplyCommand("/hodoscope/replay "+replay);
+    }
   }
   else {
     UImanager->ApplyCommand("/control/execute init_vis.mac");
     if (ui->IsGUI()) {
       UImanager->ApplyCommand("/control/execute gui.mac");
     }     
+    // the replayed event is drawn
+    if ( !replay.empty() ) {
+      UImanager->ApplyCommand("/hodoscope/replay "+replay);
+    }
     // start interactive session
     ui->SessionStart();
     delete ui;
@@ -0,0 +1,318 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file AcceptanceCounter.cc
+/// \brief Implementation of the AcceptanceCounter class
+
+#include "AcceptanceCounter.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+  // regularized incomplete beta function I_x(a,b)
+  // (continued fraction, Numerical Recipes betacf)
+  G4double BetaContinuedFraction(const G4double a, const G4double b, const G4double x)
+  {
+    const G4int kMaxIterations = 300;
+    const G4double kEpsilon = 1.e-14;
+    const G4double kTiny = 1.e-300;
+
+    auto c = 1.;
+    auto d = 1.-(a+b)*x/(a+1.);
+    if(std::fabs(d)<kTiny) d = kTiny;
+    d = 1./d;
+    auto h = d;
+    for(G4int m = 1; m <= kMaxIterations; ++m){
+      auto m2 = 2.*m;
+      auto aa = m*(b-m)*x/((a+m2-1.)*(a+m2));
+      d = 1.+aa*d;
+      if(std::fabs(d)<kTiny) d = kTiny;
+      c = 1.+aa/c;
+      if(std::fabs(c)<kTiny) c = kTiny;
+      d = 1./d;
+      h *= d*c;
+      aa = -(a+m)*(a+b+m)*x/((a+m2)*(a+m2+1.));
+      d = 1.+aa*d;
+      if(std::fabs(d)<kTiny) d = kTiny;
+      c = 1.+aa/c;
+      if(std::fabs(c)<kTiny) c = kTiny;
+      d = 1./d;
+      auto delta = d*c;
+      h *= delta;
+      if(std::fabs(delta-1.)<kEpsilon) break;
+    }
+    return h;
+  }
+
+  G4double IncompleteBeta(const G4double a, const G4double b, const G4double x)
+  {
+    if(x<=0.) return 0.;
+    if(x>=1.) return 1.;
+    auto front = std::exp(std::lgamma(a+b)-std::lgamma(a)-std::lgamma(b)
+                          +a*std::log(x)+b*std::log(1.-x));
+    if(x<(a+1.)/(a+b+2.)) return front*BetaContinuedFraction(a,b,x)/a;
+    return 1.-front*BetaContinuedFraction(b,a,1.-x)/b;
+  }
+
+  // x such that I_x(a,b) = p (bisection, I_x increases with x)
+  G4double InverseIncompleteBeta(const G4double a, const G4double b, const G4double p)
+  {
+    G4double low = 0.;
+    G4double high = 1.;
+    for(G4int i = 0; i < 100; ++i){
+      auto middle = 0.5*(low+high);
+      if(IncompleteBeta(a,b,middle)<p) low = middle;
+      else high = middle;
+    }
+    return 0.5*(low+high);
+  }
+
+  // two-sided Clopper-Pearson interval
+  void ClopperPearson(const G4long k, const G4long n, const G4double confidence_level,
+                      G4double& lower, G4double& upper)
+  {
+    auto alpha = 1.-confidence_level;
+    lower = (k==0) ? 0. : InverseIncompleteBeta(k,n-k+1,0.5*alpha);
+    upper = (k==n) ? 1. : InverseIncompleteBeta(k+1,n-k,1.-0.5*alpha);
+  }
+
+  // Wilson score interval
+  void Wilson(const G4long k, const G4long n, const G4double confidence_level,
+              G4double& lower, G4double& upper)
+  {
+    // z such that erf(z/sqrt(2)) = confidence level (bisection)
+    G4double low = 0.;
+    G4double high = 10.;
+    for(G4int i = 0; i < 100; ++i){
+      auto middle = 0.5*(low+high);
+      if(std::erf(middle/std::sqrt(2.))<confidence_level) low = middle;
+      else high = middle;
+    }
+    auto z = 0.5*(low+high);
+
+    auto p = (G4double)k/n;
+    auto z2n = z*z/n;
+    auto center = (p+0.5*z2n)/(1.+z2n);
+    auto half_width = z*std::sqrt(p*(1.-p)/n+0.25*z2n/n)/(1.+z2n);
+    lower = std::max(0.,center-half_width);
+    upper = std::min(1.,center+half_width);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+AcceptanceCounter::AcceptanceCounter()
+: G4VAccumulable("acceptance"), confidence_level_(0.6827), messenger_(nullptr)
+{
+  pattern_counts_.fill(0);
+
+  // coincidence of all the hodoscopes
+  G4String coincidence;
+  for(auto i_hodoscope = 0; i_hodoscope < Hodoscope::kTotalNumber; ++i_hodoscope){
+    if(i_hodoscope) coincidence += "&";
+    coincidence += Hodoscope::detector_name[i_hodoscope];
+  }
+  coincidence_masks_.push_back((1<<Hodoscope::kTotalNumber)-1);
+  coincidence_names_.push_back(coincidence);
+
+  // the master reports the merged counts
+  if(G4Threading::IsMasterThread()) DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+AcceptanceCounter::~AcceptanceCounter()
+{
+  delete messenger_;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AcceptanceCounter::DefineCommands()
+{
+  // Define /hodoscope/acceptance/ command directory using generic messenger class
+  messenger_ 
+    = new G4GenericMessenger(this, 
+        "/hodoscope/acceptance/", 
+        "Acceptance report control");
+
+  // confidenceLevel command
+  auto& levelCmd
+    = messenger_->DeclareProperty("confidenceLevel", confidence_level_,
+        "Confidence level of the acceptance intervals.");
+  levelCmd.SetParameterName("level", false);
+  levelCmd.SetRange("level>0. && level<1.");
+  levelCmd.SetStates(G4State_PreInit, G4State_Idle);
+  levelCmd.SetToBeBroadcasted(false);
+
+  // addCoincidence command
+  G4String candidates;
+  for(auto i_detector = 0; i_detector < kTotalDetectors; ++i_detector){
+    if(i_detector) candidates += ", ";
+    candidates += GetDetectorName(i_detector);
+  }
+  auto& coincidenceCmd
+    = messenger_->DeclareMethod("addCoincidence", &AcceptanceCounter::AddCoincidence,
+        "Report the acceptance of the coincidence of detectors joined by '+'\n"
+        "(e.g. cdh+dcin), from: "+candidates+".");
+  coincidenceCmd.SetParameterName("detectors", false);
+  coincidenceCmd.SetStates(G4State_PreInit, G4State_Idle);
+  coincidenceCmd.SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AcceptanceCounter::AddCoincidence(const G4String& detectors)
+{
+  G4int mask = 0;
+  std::istringstream names(detectors);
+  std::string name;
+  while(std::getline(names,name,'+')){
+    auto i_detector = 0;
+    while(i_detector < kTotalDetectors && GetDetectorName(i_detector)!=name) ++i_detector;
+    if(i_detector==kTotalDetectors){
+      G4ExceptionDescription msg;
+      msg << "Unknown detector " << name << " in " << detectors
+          << ", the coincidence is not added." << G4endl; 
+      G4Exception("AcceptanceCounter::AddCoincidence()",
+          "Code004", JustWarning, msg);
+      return;
+    }
+    mask |= 1<<i_detector;
+  }
+  if(mask==0) return;
+  // reported as cdh&dcin, the hit patterns as cdh+dcin
+  G4String name_list = detectors;
+  std::replace(name_list.begin(),name_list.end(),'+','&');
+  coincidence_masks_.push_back(mask);
+  coincidence_names_.push_back(name_list);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AcceptanceCounter::Merge(const G4VAccumulable& other)
+{
+  const auto& counter = static_cast<const AcceptanceCounter&>(other);
+  for(auto i_pattern = 0; i_pattern < kTotalPatterns; ++i_pattern){
+    pattern_counts_[i_pattern] += counter.pattern_counts_[i_pattern];
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AcceptanceCounter::Reset()
+{
+  pattern_counts_.fill(0);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const G4String& AcceptanceCounter::GetDetectorName(const G4int i_detector)
+{
+  if(i_detector<Hodoscope::kTotalNumber) return Hodoscope::detector_name[i_detector];
+  return TrackingPlane::detector_name[i_detector-Hodoscope::kTotalNumber];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4long AcceptanceCounter::GetTotalEvents() const
+{
+  return GetTotalEvents(0);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4long AcceptanceCounter::GetTotalEvents(const G4int mask) const
+{
+  G4long total = 0;
+  for(auto i_pattern = 0; i_pattern < kTotalPatterns; ++i_pattern){
+    if((i_pattern&mask)==mask) total += pattern_counts_[i_pattern];
+  }
+  return total;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AcceptanceCounter::PrintAcceptance(const G4String& name, const G4long accepted,
+    const G4long thrown) const
+{
+  G4double wilson_lower, wilson_upper;
+  G4double cp_lower, cp_upper;
+  Wilson(accepted,thrown,confidence_level_,wilson_lower,wilson_upper);
+  ClopperPearson(accepted,thrown,confidence_level_,cp_lower,cp_upper);
+
+  G4cout << " " << std::left << std::setw(24) << name << std::right
+         << std::setw(10) << accepted
+         << std::setw(12) << std::setprecision(5) << (G4double)accepted/thrown
+         << "  [" << wilson_lower << ", " << wilson_upper << "]"
+         << "  [" << cp_lower << ", " << cp_upper << "]" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AcceptanceCounter::Print() const
+{
+  auto thrown = GetTotalEvents();
+  if(thrown==0) return;
+
+  G4cout << " acceptance of " << thrown << " thrown events ("
+         << 100.*confidence_level_ << "% CL intervals: Wilson, Clopper-Pearson)" << G4endl;
+
+  // every detector
+  for(auto i_detector = 0; i_detector < kTotalDetectors; ++i_detector){
+    PrintAcceptance(GetDetectorName(i_detector),GetTotalEvents(1<<i_detector),thrown);
+  }
+
+  // coincidences (at least these detectors)
+  for(size_t i_coincidence = 0; i_coincidence < coincidence_masks_.size(); ++i_coincidence){
+    PrintAcceptance(coincidence_names_[i_coincidence],
+                    GetTotalEvents(coincidence_masks_[i_coincidence]),thrown);
+  }
+
+  // exact hit patterns
+  G4cout << " hit patterns:" << G4endl;
+  for(auto i_pattern = 0; i_pattern < kTotalPatterns; ++i_pattern){
+    if(pattern_counts_[i_pattern]==0) continue;
+    G4String pattern;
+    for(auto i_detector = 0; i_detector < kTotalDetectors; ++i_detector){
+      if(!(i_pattern&(1<<i_detector))) continue;
+      if(!pattern.empty()) pattern += "+";
+      pattern += GetDetectorName(i_detector);
+    }
+    if(pattern.empty()) pattern = "(none)";
+    PrintAcceptance(pattern,pattern_counts_[i_pattern],thrown);
+  }
+  G4cout << std::setprecision(6);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -31,6 +31,8 @@
 #include "PrimaryGeneratorAction.hh"
 #include "RunAction.hh"
 #include "EventAction.hh"
+#include "SteppingAction.hh"
+#include "TrackingAction.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -56,9 +58,14 @@ void ActionInitialization::Build() const
 {
   SetUserAction(new PrimaryGeneratorAction);
 
-  SetUserAction(new EventAction);
+  auto event_action = new EventAction;
+  SetUserAction(event_action);
 
-  SetUserAction(new RunAction);
+  SetUserAction(new RunAction(event_action));
+
+  // stepping profiler (no-op unless /hodoscope/profile/enable)
+  SetUserAction(new TrackingAction);
+  SetUserAction(new SteppingAction);
 }  
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
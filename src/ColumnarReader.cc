@@ -0,0 +1,229 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ColumnarReader.cc
+/// \brief Implementation of the ColumnarReader class
+
+#include "ColumnarReader.hh"
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef WITH_LZ4
+#include <lz4.h>
+#endif
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+  template <class T>
+  inline T ReadValue(const char* data, size_t& offset)
+  {
+    T value;
+    std::memcpy(&value,data+offset,sizeof(T));
+    offset += sizeof(T);
+    return value;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ColumnarReader::ColumnarReader()
+: data_(nullptr), size_(0), total_rows_(0)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ColumnarReader::~ColumnarReader()
+{
+  Close();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool ColumnarReader::Open(const std::string& file_name)
+{
+  Close();
+
+  auto descriptor = open(file_name.c_str(),O_RDONLY);
+  if(descriptor<0){
+    error_ = "cannot open "+file_name;
+    return false;
+  }
+  struct stat status;
+  if(fstat(descriptor,&status)<0 || status.st_size<(off_t)(2*sizeof(Columnar::kMagic)+24)){
+    close(descriptor);
+    error_ = file_name+" is not a columnar event file";
+    return false;
+  }
+  size_ = status.st_size;
+  auto mapping = mmap(nullptr,size_,PROT_READ,MAP_PRIVATE,descriptor,0);
+  close(descriptor);
+  if(mapping==MAP_FAILED){
+    error_ = "cannot map "+file_name;
+    return false;
+  }
+  data_ = static_cast<const char*>(mapping);
+
+  // magics at both ends (an unterminated file has no footer)
+  if(std::memcmp(data_,Columnar::kMagic,sizeof(Columnar::kMagic))!=0 ||
+      std::memcmp(data_+size_-sizeof(Columnar::kMagic),Columnar::kMagic,
+        sizeof(Columnar::kMagic))!=0){
+    return Fail(file_name+" is not a complete columnar event file");
+  }
+
+  // header (the footer offset is checked before reading the names, which
+  // must end before it)
+  const auto footer_end = size_-sizeof(Columnar::kMagic)-sizeof(std::uint64_t);
+  size_t offset = footer_end;
+  auto footer_offset = ReadValue<std::uint64_t>(data_,offset);
+  if(footer_offset<sizeof(Columnar::kMagic)+2*sizeof(std::uint32_t) ||
+      footer_offset>footer_end-2*sizeof(std::uint64_t)){
+    return Fail(file_name+" has an invalid footer offset");
+  }
+
+  offset = sizeof(Columnar::kMagic);
+  auto version = ReadValue<std::uint32_t>(data_,offset);
+  if(version!=Columnar::kVersion){
+    return Fail(file_name+" has an unknown format version");
+  }
+  auto total_columns = ReadValue<std::uint32_t>(data_,offset);
+  if(total_columns>(footer_offset-offset)/(2*sizeof(std::uint32_t))){
+    return Fail(file_name+" has an invalid number of columns");
+  }
+  for(std::uint32_t i_column=0; i_column<total_columns; i_column++){
+    if(offset+2*sizeof(std::uint32_t)>footer_offset){
+      return Fail(file_name+" has a truncated header");
+    }
+    auto type = ReadValue<std::uint32_t>(data_,offset);
+    auto length = ReadValue<std::uint32_t>(data_,offset);
+    if(type>Columnar::kFloat32 || length>footer_offset-offset){
+      return Fail(file_name+" has an invalid column definition");
+    }
+    types_.push_back((Columnar::ColumnType)type);
+    names_.push_back(std::string(data_+offset,length));
+    offset += length;
+  }
+  const auto header_end = offset;
+
+  // footer
+  offset = footer_offset;
+  total_rows_ = ReadValue<std::uint64_t>(data_,offset);
+  auto total_blocks = ReadValue<std::uint64_t>(data_,offset);
+  if(total_blocks>(footer_end-offset)/sizeof(Columnar::ColumnBlock)){
+    return Fail(file_name+" has an invalid number of blocks");
+  }
+  blocks_.resize(total_blocks);
+  for(auto& block: blocks_){
+    block = ReadValue<Columnar::ColumnBlock>(data_,offset);
+    // inside the block area and 8-byte aligned, of a known column and
+    // codec, whole values
+    if(block.column>=total_columns || block.codec>Columnar::kZlib ||
+        block.offset<header_end || block.offset>footer_offset || block.offset%8!=0 ||
+        block.stored_size>footer_offset-block.offset ||
+        block.raw_size%Columnar::GetTypeSize(types_[block.column])!=0 ||
+        (block.codec==Columnar::kNone && block.raw_size!=block.stored_size)){
+      return Fail(file_name+" has an invalid block");
+    }
+  }
+
+  error_.clear();
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool ColumnarReader::Fail(const std::string& error)
+{
+  Close();
+  error_ = error;
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ColumnarReader::Close()
+{
+  if(data_) munmap(const_cast<char*>(data_),size_);
+  data_ = nullptr;
+  size_ = 0;
+  names_.clear();
+  types_.clear();
+  blocks_.clear();
+  total_rows_ = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int ColumnarReader::FindColumn(const std::string& name) const
+{
+  for(size_t i_column=0; i_column<names_.size(); i_column++){
+    if(names_[i_column]==name) return i_column;
+  }
+  return -1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const char* ColumnarReader::GetBlockData(const Columnar::ColumnBlock& block,
+    std::vector<char>& buffer) const
+{
+  auto stored = GetStoredData(block);
+  if(block.codec==Columnar::kNone) return stored;
+
+  buffer.resize(block.raw_size);
+#ifdef WITH_LZ4
+  if(block.codec==Columnar::kLZ4){
+    auto size = LZ4_decompress_safe(stored,buffer.data(),block.stored_size,block.raw_size);
+    return size==(int)block.raw_size ? buffer.data() : nullptr;
+  }
+#endif
+#ifdef WITH_ZSTD
+  if(block.codec==Columnar::kZstd){
+    auto size = ZSTD_decompress(buffer.data(),block.raw_size,stored,block.stored_size);
+    return size==block.raw_size ? buffer.data() : nullptr;
+  }
+#endif
+#ifdef WITH_ZLIB
+  if(block.codec==Columnar::kZlib){
+    uLongf size = block.raw_size;
+    auto status = uncompress(reinterpret_cast<Bytef*>(buffer.data()),&size,
+        reinterpret_cast<const Bytef*>(stored),block.stored_size);
+    return (status==Z_OK && size==block.raw_size) ? buffer.data() : nullptr;
+  }
+#endif
+  return nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,278 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ColumnarWriter.cc
+/// \brief Implementation of the ColumnarWriter class
+
+#include "ColumnarWriter.hh"
+
+#include <algorithm>
+#include <chrono>
+
+#ifdef WITH_LZ4
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+  template <class T>
+  inline void WriteValue(std::ofstream& file, const T& value, std::uint64_t& offset)
+  {
+    file.write(reinterpret_cast<const char*>(&value),sizeof(T));
+    offset += sizeof(T);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ColumnarWriter::ColumnarWriter()
+: offset_(0), codec_(Columnar::kNone), level_(0), chunk_rows_(65536),
+  chunk_first_row_(0), total_rows_(0), raw_bytes_(0), stored_bytes_(0),
+  compress_seconds_(0.)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ColumnarWriter::~ColumnarWriter()
+{
+  Close();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::uint32_t ColumnarWriter::DefineColumn(const std::string& name,
+    const Columnar::ColumnType type)
+{
+  Column column;
+  column.name = name;
+  column.type = type;
+  column.total_entries = 0;
+  columns_.push_back(column);
+  return columns_.size()-1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ColumnarWriter::ClearColumns()
+{
+  columns_.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool ColumnarWriter::IsCodecAvailable(const Columnar::ColumnCodec codec)
+{
+  switch(codec){
+    case Columnar::kNone: return true;
+#ifdef WITH_LZ4
+    case Columnar::kLZ4: return true;
+#endif
+#ifdef WITH_ZSTD
+    case Columnar::kZstd: return true;
+#endif
+#ifdef WITH_ZLIB
+    case Columnar::kZlib: return true;
+#endif
+    default: return false;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool ColumnarWriter::SetCodec(const Columnar::ColumnCodec codec, const int level)
+{
+  if(!IsCodecAvailable(codec)){
+    codec_ = Columnar::kNone;
+    level_ = 0;
+    return false;
+  }
+  codec_ = codec;
+  level_ = level;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool ColumnarWriter::Open(const std::string& file_name)
+{
+  Close();
+
+  file_.open(file_name.c_str(),std::ios::binary|std::ios::trunc);
+  if(!file_) return false;
+
+  offset_ = 0;
+  chunk_first_row_ = 0;
+  total_rows_ = 0;
+  raw_bytes_ = 0;
+  stored_bytes_ = 0;
+  compress_seconds_ = 0.;
+  blocks_.clear();
+
+  // schema header
+  file_.write(Columnar::kMagic,sizeof(Columnar::kMagic));
+  offset_ += sizeof(Columnar::kMagic);
+  WriteValue(file_,Columnar::kVersion,offset_);
+  WriteValue(file_,(std::uint32_t)columns_.size(),offset_);
+  for(auto& column: columns_){
+    WriteValue(file_,(std::uint32_t)column.type,offset_);
+    WriteValue(file_,(std::uint32_t)column.name.size(),offset_);
+    file_.write(column.name.data(),column.name.size());
+    offset_ += column.name.size();
+    column.buffer.clear();
+    column.total_entries = 0;
+  }
+  Pad();
+
+  if(!file_){
+    file_.close();
+    return false;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool ColumnarWriter::Close()
+{
+  if(!file_.is_open()) return true;
+
+  FlushChunk();
+
+  // footer index
+  auto footer_offset = offset_;
+  WriteValue(file_,total_rows_,offset_);
+  WriteValue(file_,(std::uint64_t)blocks_.size(),offset_);
+  for(const auto& block: blocks_) WriteValue(file_,block,offset_);
+  WriteValue(file_,footer_offset,offset_);
+  file_.write(Columnar::kMagic,sizeof(Columnar::kMagic));
+  offset_ += sizeof(Columnar::kMagic);
+
+  // the stream state is sticky: any failed write since Open is reported
+  file_.close();
+  return !file_.fail();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool ColumnarWriter::FlushChunk()
+{
+  if(total_rows_==chunk_first_row_) return !file_.fail();
+
+  auto written = true;
+  for(std::uint32_t i_column=0; i_column<columns_.size(); i_column++){
+    written = WriteBlock(i_column,columns_[i_column]) && written;
+  }
+  chunk_first_row_ = total_rows_;
+  return written;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool ColumnarWriter::WriteBlock(const std::uint32_t column, Column& data)
+{
+  Columnar::ColumnBlock block;
+  block.column = column;
+  block.codec = Columnar::kNone;
+  block.first_row = chunk_first_row_;
+  block.total_rows = total_rows_-chunk_first_row_;
+  block.total_entries = data.buffer.size()/Columnar::GetTypeSize(data.type);
+  block.offset = offset_;
+  block.raw_size = data.buffer.size();
+  block.stored_size = data.buffer.size();
+
+  const char* stored = data.buffer.data();
+  size_t compressed_size = 0;
+  auto start = std::chrono::steady_clock::now();
+#ifdef WITH_LZ4
+  if(codec_==Columnar::kLZ4 && !data.buffer.empty()){
+    compressed_.resize(LZ4_compressBound(data.buffer.size()));
+    if(level_>LZ4HC_CLEVEL_MIN-1){
+      compressed_size = LZ4_compress_HC(data.buffer.data(),compressed_.data(),
+          data.buffer.size(),compressed_.size(),level_);
+    }
+    else{
+      compressed_size = LZ4_compress_default(data.buffer.data(),compressed_.data(),
+          data.buffer.size(),compressed_.size());
+    }
+  }
+#endif
+#ifdef WITH_ZSTD
+  if(codec_==Columnar::kZstd && !data.buffer.empty()){
+    compressed_.resize(ZSTD_compressBound(data.buffer.size()));
+    compressed_size = ZSTD_compress(compressed_.data(),compressed_.size(),
+        data.buffer.data(),data.buffer.size(),level_);
+    if(ZSTD_isError(compressed_size)) compressed_size = 0;
+  }
+#endif
+#ifdef WITH_ZLIB
+  if(codec_==Columnar::kZlib && !data.buffer.empty()){
+    uLongf size = compressBound(data.buffer.size());
+    compressed_.resize(size);
+    auto status = compress2(reinterpret_cast<Bytef*>(compressed_.data()),&size,
+        reinterpret_cast<const Bytef*>(data.buffer.data()),data.buffer.size(),
+        level_>0 ? level_ : Z_DEFAULT_COMPRESSION);
+    compressed_size = (status==Z_OK) ? size : 0;
+  }
+#endif
+  if(codec_!=Columnar::kNone){
+    compress_seconds_ += std::chrono::duration<double>(
+        std::chrono::steady_clock::now()-start).count();
+  }
+  // keep the raw block if the compression does not save space
+  if(compressed_size>0 && compressed_size<data.buffer.size()){
+    block.codec = codec_;
+    block.stored_size = compressed_size;
+    stored = compressed_.data();
+  }
+
+  file_.write(stored,block.stored_size);
+  offset_ += block.stored_size;
+  Pad();
+
+  raw_bytes_ += block.raw_size;
+  stored_bytes_ += block.stored_size;
+  blocks_.push_back(block);
+  data.buffer.clear();
+  return !file_.fail();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ColumnarWriter::Pad()
+{
+  static const char zeros[8] = {0,0,0,0,0,0,0,0};
+  auto padding = (8-offset_%8)%8;
+  file_.write(zeros,padding);
+  offset_ += padding;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
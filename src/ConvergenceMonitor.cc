@@ -0,0 +1,212 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ConvergenceMonitor.cc
+/// \brief Implementation of the ConvergenceMonitor class
+
+#include "ConvergenceMonitor.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ConvergenceMonitor* ConvergenceMonitor::instance_ = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ConvergenceMonitor* ConvergenceMonitor::Instance()
+{
+  // created by the master before the workers start
+  if(!instance_) instance_ = new ConvergenceMonitor();
+  return instance_;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ConvergenceMonitor::ConvergenceMonitor()
+: converged_(false), target_(0.), min_events_(1000), messenger_(nullptr)
+{
+  for(auto& counter: counters_){
+    for(auto& count: counter.pattern_counts) count = 0;
+  }
+  SetSelection("coincidence");
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ConvergenceMonitor::~ConvergenceMonitor()
+{
+  delete messenger_;
+  instance_ = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ConvergenceMonitor::DefineCommands()
+{
+  // Define /hodoscope/convergence/ command directory using generic messenger class
+  messenger_ 
+    = new G4GenericMessenger(this, 
+        "/hodoscope/convergence/", 
+        "Convergence-driven termination of the runs");
+
+  // target command
+  auto& targetCmd
+    = messenger_->DeclareProperty("target", target_,
+        "Target relative uncertainty of the acceptance (0: run all the events).");
+  targetCmd.SetParameterName("target", false);
+  targetCmd.SetRange("target>=0.");
+  targetCmd.SetStates(G4State_PreInit, G4State_Idle);
+  targetCmd.SetToBeBroadcasted(false);
+
+  // select command
+  auto& selectCmd
+    = messenger_->DeclareMethod("select", &ConvergenceMonitor::SetSelection);
+  G4String guidance
+    = "Acceptances required to converge.\n";
+  guidance
+    += "  all         : every detector and the coincidence of the hodoscopes\n";
+  guidance
+    += "  coincidence : at least one hit segment in every hodoscope\n";
+  guidance
+    += "  <detector>  : at least one hit in this hodoscope or tracking plane";
+  selectCmd.SetGuidance(guidance);
+  selectCmd.SetParameterName("selection", false);
+  G4String candidates = "all coincidence";
+  for(auto i_detector = 0; i_detector < AcceptanceCounter::kTotalDetectors; ++i_detector){
+    candidates += " "+AcceptanceCounter::GetDetectorName(i_detector);
+  }
+  selectCmd.SetCandidates(candidates);
+  selectCmd.SetStates(G4State_PreInit, G4State_Idle);
+  selectCmd.SetToBeBroadcasted(false);
+
+  // minEvents command
+  auto& minEventsCmd
+    = messenger_->DeclareProperty("minEvents", min_events_,
+        "Minimum number of events before the run can stop.");
+  minEventsCmd.SetParameterName("events", false);
+  minEventsCmd.SetRange("events>=0");
+  minEventsCmd.SetStates(G4State_PreInit, G4State_Idle);
+  minEventsCmd.SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ConvergenceMonitor::SetSelection(const G4String& selection)
+{
+  selection_ = selection;
+  masks_.clear();
+
+  const auto coincidence = (1<<Hodoscope::kTotalNumber)-1;
+  if(selection=="coincidence") masks_.push_back(coincidence);
+
+  for(auto i_detector = 0; i_detector < AcceptanceCounter::kTotalDetectors; ++i_detector){
+    if(selection=="all" || selection==AcceptanceCounter::GetDetectorName(i_detector)){
+      masks_.push_back(1<<i_detector);
+    }
+  }
+  if(selection=="all") masks_.push_back(coincidence);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ConvergenceMonitor::Reset()
+{
+  for(auto& counter: counters_){
+    for(auto& count: counter.pattern_counts) count = 0;
+  }
+  converged_ = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double ConvergenceMonitor::GetRelativeUncertainty(G4long& total_events) const
+{
+  // sum of the threads
+  G4long pattern_counts[AcceptanceCounter::kTotalPatterns] = {};
+  for(const auto& counter: counters_){
+    for(auto i_pattern = 0; i_pattern < AcceptanceCounter::kTotalPatterns; ++i_pattern){
+      pattern_counts[i_pattern]
+        += counter.pattern_counts[i_pattern].load(std::memory_order_relaxed);
+    }
+  }
+
+  total_events = 0;
+  for(auto count: pattern_counts) total_events += count;
+  if(total_events==0) return DBL_MAX;
+
+  G4double relative_uncertainty = 0.;
+  for(auto mask: masks_){
+    G4long accepted = 0;
+    for(auto i_pattern = 0; i_pattern < AcceptanceCounter::kTotalPatterns; ++i_pattern){
+      if((i_pattern&mask)==mask) accepted += pattern_counts[i_pattern];
+    }
+    // no estimate yet
+    if(accepted==0) return DBL_MAX;
+    relative_uncertainty
+      = std::max(relative_uncertainty,
+                 std::sqrt((G4double)(total_events-accepted)/(total_events*accepted)));
+  }
+  return relative_uncertainty;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ConvergenceMonitor::Check()
+{
+  G4long total_events = 0;
+  auto relative_uncertainty = GetRelativeUncertainty(total_events);
+  if(total_events>=min_events_ && relative_uncertainty<target_){
+    converged_.store(true,std::memory_order_relaxed);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ConvergenceMonitor::Print() const
+{
+  if(target_<=0.) return;
+
+  G4long total_events = 0;
+  auto relative_uncertainty = GetRelativeUncertainty(total_events);
+  G4cout << " convergence: " << selection_ << " acceptance ";
+  if(relative_uncertainty<DBL_MAX){
+    G4cout << "relative uncertainty " << relative_uncertainty;
+  }
+  else{
+    G4cout << "not measured";
+  }
+  G4cout << " (target " << target_ << ") after " << total_events << " events, "
+         << (converged_ ? "converged" : "not converged") << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -71,7 +71,8 @@ G4ThreadLocal G4FieldManager* DetectorConstruction::field_manager_ = 0;
 
 DetectorConstruction::DetectorConstruction()
   : G4VUserDetectorConstruction(), 
-  magnetic_logical_(nullptr), cdh_logical_(nullptr)
+  world_physical_(nullptr),
+  magnetic_logical_(nullptr), cdh_logical_(nullptr), disc_logical_(nullptr)
 {
 }
 
@@ -112,7 +113,7 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
     = new G4Box("world_solid",10.*m,3.*m,10.*m);
   auto world_logical
     = new G4LogicalVolume(world_solid,air,"world_logical");
-  auto world_physical
+  world_physical_
     = new G4PVPlacement(0,G4ThreeVector(),world_logical,"world_physical",0,
         false,0,kCheckOverlaps);
 
@@ -186,7 +187,7 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
 
   // return the world physical volume ----------------------------------------
 
-  return world_physical;
+  return world_physical_;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -200,9 +201,11 @@ void DetectorConstruction::ConstructSDandField()
   auto cdh = new HodoscopeSD(sensitive_detector_name="/cdh");
   sdManager->AddNewDetector(cdh);
   cdh_logical_->SetSensitiveDetector(cdh);
+  cdh->CacheSegmentPlacements(world_physical_);
   auto disc = new HodoscopeSD(sensitive_detector_name="/disc");
   sdManager->AddNewDetector(disc);
   disc_logical_->SetSensitiveDetector(disc);
+  disc->CacheSegmentPlacements(world_physical_);
   // -------------------------------------------------------------------------
 
   // magnetic field ----------------------------------------------------------
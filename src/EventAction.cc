@@ -29,9 +29,16 @@
 
 #include "EventAction.hh"
 #include "HodoscopeHit.hh"
+#include "TrackingPlaneHit.hh"
+#include "EventWriter.hh"
+#include "ProgressMeter.hh"
+#include "EventSeeder.hh"
+#include "AcceptanceCounter.hh"
+#include "ConvergenceMonitor.hh"
 #include "Analysis.hh"
 
 #include "G4Event.hh"
+#include "G4Run.hh"
 #include "G4RunManager.hh"
 #include "G4EventManager.hh"
 #include "G4HCofThisEvent.hh"
@@ -70,13 +77,12 @@ namespace {
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 EventAction::EventAction()
-  : G4UserEventAction() 
+  : G4UserEventAction(), id_column_(-1), acceptance_(nullptr)
 {
-  G4RunManager::GetRunManager()->SetPrintProgress(1);
-
-  for(auto id: hodoscope_hitscollection_id_){
-    id = -1;
-  }
+  hodoscope_hitscollection_id_.fill(-1);
+  hodoscope_total_segments_.fill(0);
+  hodoscope_energy_deposit_.fill(0.);
+  tracking_plane_hitscollection_id_.fill(-1);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -103,76 +109,200 @@ void EventAction::BeginOfEventAction(const G4Event*)
     }
   }
 
+  // tracking planes
+  if (tracking_plane_hitscollection_id_[0] == -1) {
+    auto sd_manager = G4SDManager::GetSDMpointer();
+
+    for (auto i_plane = 0; i_plane < TrackingPlane::kTotalNumber; ++i_plane) {
+      auto collection_name = TrackingPlane::detector_name[i_plane];
+      collection_name += "/tracking_plane_hitscollection";
+      tracking_plane_hitscollection_id_[i_plane]
+        = sd_manager->GetCollectionID(collection_name);
+    }
+  }
+
 }     
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 void EventAction::EndOfEventAction(const G4Event* event)
 {
+  ProgressMeter::Instance()->CountEvent();
+
   // Get analysis manager
   auto analysisManager = G4AnalysisManager::Instance();
 
+  // detailed printing on /run/printProgress boundaries
+  auto print_modulo = G4RunManager::GetRunManager()->GetPrintProgress();
+  G4bool print_event = (print_modulo>0 && event->GetEventID()%print_modulo==0);
+
   // ======================================================
-  // DCIN =================================================
+  // Hodoscopes ===========================================
   // ======================================================
-  //G4int dcin_total_hits = 0;
-  //G4ThreeVector dcin_position = G4ThreeVector(0);
-  //G4ThreeVector dcin_momentum = G4ThreeVector(0);
-  //G4bool dcin_has_hit = false;
+  // the summaries are accumulated by HodoscopeSD, step by step
+  array<G4VHitsCollection*, Hodoscope::kTotalNumber> hodoscope_hc;
+  for(auto i_hodoscope = 0; i_hodoscope < Hodoscope::kTotalNumber; ++i_hodoscope){
+    hodoscope_total_segments_[i_hodoscope] = 0;
+    hodoscope_energy_deposit_[i_hodoscope] = 0.;
+    record_.hodoscopes[i_hodoscope].Clear();
+
+    auto hc = GetHC(event, hodoscope_hitscollection_id_[i_hodoscope]);
+    hodoscope_hc[i_hodoscope] = hc;
+    if(!hc) continue;
+
+    auto total_segments = (G4int)hc->GetSize();
+    hodoscope_total_segments_[i_hodoscope] = total_segments;
+    if(!print_event && !filter_.NeedsEnergyDeposit()) continue;
 
-  //auto dcin_hc = GetHC(event,dc_hitcollection_id_[kDCINId]); 
-  //if(dcin_hc){
-  //  dcin_total_hits = dcin_hc->GetSize();
-  //  analysisManager->FillH1(dc_histogram_id_[0][kDCINId], dcin_total_hits );
+    for(auto i_hit = 0; i_hit < total_segments; ++i_hit){
+      auto hit = static_cast<HodoscopeHit*>(hc->GetHit(i_hit));
+      hodoscope_energy_deposit_[i_hodoscope] += hit->GetTotalEnergyDeposit();
+    }
+
+    if(print_event){
+      G4cout << "Hodoscope " << Hodoscope::detector_name[i_hodoscope]
+             << " has " << total_segments << " hit segments, "
+             << hodoscope_energy_deposit_[i_hodoscope]/MeV << " MeV deposited." << G4endl;
+    }
+  }
+  // ======================================================
+  // ======================================================
 
-  //  if(dcin_total_hits>0){
-  //    dcin_has_hit = true;
-  //    auto hit = static_cast<HodoscopeHit*>(dcin_hc->GetHit(0));
-  //    dcin_position = hit->GetGlobalPosition();
-  //    dcin_momentum = hit->GetMomentum();
-  //    analysisManager->FillH1(dc_histogram_id_[1][kDCINId], dcin_momentum.theta()/deg);
-  //    analysisManager->FillH2(dc_histogram_id_[2][kDCINId], dcin_position.x(), dcin_position.y());
-  //  }
-  //}
   // ======================================================
+  // DCIN / DCOUT =========================================
   // ======================================================
+  // histogram and ntuple column IDs as booked in RunAction
+  for(auto i_plane = 0; i_plane < TrackingPlane::kTotalNumber; ++i_plane){
+    G4int total_hits = 0;
+    G4ThreeVector position = G4ThreeVector(0);
+    G4ThreeVector momentum = G4ThreeVector(0);
 
+    auto hc = GetHC(event, tracking_plane_hitscollection_id_[i_plane]);
+    if(hc){
+      total_hits = hc->GetSize();
+      analysisManager->FillH1(i_plane, total_hits);
 
+      if(total_hits>0){
+        auto hit = static_cast<TrackingPlaneHit*>(hc->GetHit(0));
+        position = hit->GetGlobalPosition();
+        momentum = hit->GetMomentum();
+        analysisManager->FillH1(TrackingPlane::kTotalNumber+i_plane, momentum.theta()/deg);
+        analysisManager->FillH2(i_plane, position.x(), position.y());
+      }
+    }
+
+    auto& plane = record_.tracking_planes[i_plane];
+    plane.total_hits = total_hits;
+    plane.position_x = position.x();
+    plane.position_y = position.y();
+    plane.position_z = position.z();
+    plane.momentum_x = momentum.x();
+    plane.momentum_y = momentum.y();
+    plane.momentum_z = momentum.z();
+
+    if(print_event){
+      G4cout << "Tracking plane " << TrackingPlane::detector_name[i_plane]
+             << " has " << total_hits << " hits." << G4endl;
+    }
+  }
   // ======================================================
-  // Fill Tree ============================================
   // ======================================================
-  //if(dcin_has_hit){
-  //  analysisManager->FillNtupleIColumn(0,dcin_total_hits);
-  //  analysisManager->FillNtupleFColumn(1,(G4float)dcin_position.x());
-  //  analysisManager->FillNtupleFColumn(2,(G4float)dcin_position.y());
-  //  analysisManager->FillNtupleFColumn(3,(G4float)dcin_position.z());
-  //  analysisManager->FillNtupleFColumn(4,(G4float)dcin_momentum.x());
-  //  analysisManager->FillNtupleFColumn(5,(G4float)dcin_momentum.y());
-  //  analysisManager->FillNtupleFColumn(6,(G4float)dcin_momentum.z());
-  //}
-  //analysisManager->AddNtupleRow();
+
+
   // ======================================================
+  // Event filter =========================================
   // ======================================================
+  G4int total_tracking_plane_hits = 0;
+  for(const auto& plane: record_.tracking_planes){
+    total_tracking_plane_hits += plane.total_hits;
+  }
+
+  // hit pattern of the event, counted before the filter
+  G4int pattern = 0;
+  for(auto i_hodoscope = 0; i_hodoscope < Hodoscope::kTotalNumber; ++i_hodoscope){
+    if(hodoscope_total_segments_[i_hodoscope]>0) pattern |= 1<<i_hodoscope;
+  }
+  for(auto i_plane = 0; i_plane < TrackingPlane::kTotalNumber; ++i_plane){
+    if(record_.tracking_planes[i_plane].total_hits>0){
+      pattern |= 1<<(Hodoscope::kTotalNumber+i_plane);
+    }
+  }
+  if(acceptance_) acceptance_->CountEvent(pattern);
+
+  // convergence-driven run: no new event of this thread once the
+  // acceptance has converged (this event is still written)
+  if(ConvergenceMonitor::Instance()->CountEvent(pattern)){
+    G4RunManager::GetRunManager()->AbortRun(true);
+  }
 
+  // the replayed event is always written
+  auto seeder = EventSeeder::Instance();
+  if(!filter_.Accept(hodoscope_total_segments_, hodoscope_energy_deposit_,
+                     total_tracking_plane_hits, seeder->IsReplaying())){
+    return;
+  }
+
+  // per-segment columns of the accepted events
+  for(auto i_hodoscope = 0; i_hodoscope < Hodoscope::kTotalNumber; ++i_hodoscope){
+    auto hc = hodoscope_hc[i_hodoscope];
+    if(!hc) continue;
 
-  ////
-  //// Print diagnostics
-  //// 
+    auto& columns = record_.hodoscopes[i_hodoscope];
+    for(auto i_hit = 0; i_hit < hodoscope_total_segments_[i_hodoscope]; ++i_hit){
+      auto hit = static_cast<HodoscopeHit*>(hc->GetHit(i_hit));
+      auto first_time = hit->GetFirstHitTime();
+      auto position = hit->GetWeightedPosition();
 
-  //auto printModulo = G4RunManager::GetRunManager()->GetPrintProgress();
-  //if ( printModulo == 0 || event->GetEventID() % printModulo != 0) return;
+      columns.segment_id.push_back(hit->GetSegmentID());
+      columns.energy_deposit.push_back(hit->GetTotalEnergyDeposit()/MeV);
+      columns.time.push_back(first_time/ns);
+      columns.position_x.push_back(position.x()/mm);
+      columns.position_y.push_back(position.y()/mm);
+      columns.position_z.push_back(position.z()/mm);
+    }
+  }
+  // ======================================================
+  // ======================================================
 
-  // Drift chambers
-  //for (G4int i_dc = 0; i_dc < kNumberofDCs; ++i_dc) {
-  //  auto hc = GetHC(event, dc_hitcollection_id_[i_dc]);
-  //  if ( ! hc ) return;
-  //  G4cout << "Drift Chamber " << i_dc + 1 << " has " <<  hc->GetSize()  << " hits." << G4endl;
-  //}
+  // ======================================================
+  // Fill Tree ============================================
+  // ======================================================
+  // the IDs the event was seeded from (the original ones in a replay)
+  record_.seed = seeder->GetSeed();
+  if(seeder->IsReplaying()){
+    record_.run_id = seeder->GetReplayRunID();
+    record_.event_id = seeder->GetReplayEventID();
+  }
+  else{
+    record_.run_id = G4RunManager::GetRunManager()->GetCurrentRun()->GetRunID();
+    record_.event_id = event->GetEventID();
+  }
 
-  // set printing per each event
-  if(event->GetEventID()){
-    G4int print_progress = (G4int)log10(event->GetEventID());
-    G4RunManager::GetRunManager()->SetPrintProgress(pow(10,print_progress));
+  auto writer = EventWriter::Instance();
+  if(writer->IsOpen()){
+    // the vectors are moved to the queue and replaced by the ones of a
+    // drained record, with their capacity
+    writer->Push(record_);
+  }
+  else{
+    // the hodoscope vector columns are bound to record_
+    for(auto i_plane = 0; i_plane < TrackingPlane::kTotalNumber; ++i_plane){
+      const auto& plane = record_.tracking_planes[i_plane];
+      auto first_column = 7*i_plane;
+      analysisManager->FillNtupleIColumn(first_column,plane.total_hits);
+      analysisManager->FillNtupleFColumn(first_column+1,plane.position_x);
+      analysisManager->FillNtupleFColumn(first_column+2,plane.position_y);
+      analysisManager->FillNtupleFColumn(first_column+3,plane.position_z);
+      analysisManager->FillNtupleFColumn(first_column+4,plane.momentum_x);
+      analysisManager->FillNtupleFColumn(first_column+5,plane.momentum_y);
+      analysisManager->FillNtupleFColumn(first_column+6,plane.momentum_z);
+    }
+    analysisManager->FillNtupleIColumn(id_column_,record_.run_id);
+    analysisManager->FillNtupleIColumn(id_column_+1,record_.event_id);
+    analysisManager->FillNtupleIColumn(id_column_+2,record_.seed);
+    analysisManager->AddNtupleRow();
   }
+  // ======================================================
+  // ======================================================
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,147 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file EventFilter.cc
+/// \brief Implementation of the EventFilter class
+
+#include "EventFilter.hh"
+
+#include "G4GenericMessenger.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventFilter::EventFilter()
+: messenger_(nullptr), selection_(kAll), hodoscope_id_(-1),
+  min_energy_deposit_(0.),
+  total_processed_(0), total_accepted_(0)
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventFilter::~EventFilter()
+{
+  delete messenger_;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventFilter::DefineCommands()
+{
+  // Define /hodoscope/filter/ command directory using generic messenger class
+  messenger_ 
+    = new G4GenericMessenger(this, 
+        "/hodoscope/filter/", 
+        "Event filter of the output");
+
+  // select command
+  auto& selectCmd
+    = messenger_->DeclareMethod("select", &EventFilter::SetSelection);
+  G4String guidance
+    = "Events written to the output.\n";
+  guidance
+    += "  all         : every event\n";
+  guidance
+    += "  any         : at least one hit in a hodoscope or a tracking plane\n";
+  guidance
+    += "  <hodoscope> : at least one hit segment in this hodoscope\n";
+  guidance
+    += "  coincidence : at least one hit segment in every hodoscope";
+  selectCmd.SetGuidance(guidance);
+  selectCmd.SetParameterName("selection", false);
+  G4String candidates = "all any coincidence";
+  for(const auto& name: Hodoscope::detector_name) candidates += " "+name;
+  selectCmd.SetCandidates(candidates);
+  selectCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  // minEnergyDeposit command
+  auto& energyCmd
+    = messenger_->DeclarePropertyWithUnit("minEnergyDeposit", "MeV", min_energy_deposit_,
+        "Minimum total energy deposit in the hodoscopes (0: no requirement).");
+  energyCmd.SetParameterName("energy", true);
+  energyCmd.SetRange("energy>=0.");
+  energyCmd.SetDefaultValue("0.");
+  energyCmd.SetStates(G4State_PreInit, G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventFilter::SetSelection(const G4String& selection)
+{
+  hodoscope_id_ = -1;
+  if(selection=="any") selection_ = kAny;
+  else if(selection=="coincidence") selection_ = kCoincidence;
+  else selection_ = kAll;
+
+  for(auto i_hodoscope = 0; i_hodoscope < Hodoscope::kTotalNumber; ++i_hodoscope){
+    if(selection==Hodoscope::detector_name[i_hodoscope]){
+      selection_ = kHodoscope;
+      hodoscope_id_ = i_hodoscope;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool EventFilter::Accept(
+    const std::array<G4int, Hodoscope::kTotalNumber>& total_segments,
+    const std::array<G4double, Hodoscope::kTotalNumber>& energy_deposit,
+    const G4int total_tracking_plane_hits, const G4bool force)
+{
+  total_processed_++;
+  if(force){
+    total_accepted_++;
+    return true;
+  }
+
+  G4bool accepted = true;
+  switch(selection_){
+    case kAny:
+      accepted = (total_tracking_plane_hits>0);
+      for(auto n: total_segments) accepted = accepted || (n>0);
+      break;
+    case kHodoscope:
+      accepted = (total_segments[hodoscope_id_]>0);
+      break;
+    case kCoincidence:
+      for(auto n: total_segments) accepted = accepted && (n>0);
+      break;
+    default:
+      break;
+  }
+
+  if(accepted && min_energy_deposit_>0.){
+    G4double total_energy_deposit = 0.;
+    for(auto e: energy_deposit) total_energy_deposit += e;
+    accepted = (total_energy_deposit>min_energy_deposit_);
+  }
+
+  if(accepted) total_accepted_++;
+  return accepted;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,345 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file EventSeeder.cc
+/// \brief Implementation of the EventSeeder class
+
+#include "EventSeeder.hh"
+#include "Constants.hh"
+#include "Analysis.hh"
+#include "EventWriter.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4UImanager.hh"
+#include "G4ios.hh"
+#include "Randomize.hh"
+#include "CLHEP/Random/MixMaxRng.h"
+#include "CLHEP/Random/RanluxEngine.h"
+#include "CLHEP/Random/Ranlux64Engine.h"
+#include "CLHEP/Random/MTwistEngine.h"
+#include "CLHEP/Random/RanecuEngine.h"
+#include "CLHEP/Random/JamesRandom.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <sstream>
+
+namespace {
+  // SplitMix64 finalizer
+  inline std::uint64_t Mix(std::uint64_t value)
+  {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value^(value>>30))*0xbf58476d1ce4e5b9ULL;
+    value = (value^(value>>27))*0x94d049bb133111ebULL;
+    return value^(value>>31);
+  }
+
+  // default seed of the job: from the system entropy source, so that jobs
+  // started from the same macro simulate different events
+  G4int DrawSeed()
+  {
+    std::random_device device;
+    return (G4int)(device()&0x7fffffff);
+  }
+
+  // stream of the events, so that other streams can be added
+  const long kEventStream = 1;
+
+  // engine installed by InstallEngine() on this thread
+  G4ThreadLocal CLHEP::HepRandomEngine* thread_engine = nullptr;
+  G4ThreadLocal G4int thread_engine_type = -1;
+  G4ThreadLocal G4int thread_engine_luxury = -1;
+
+  // in the order of EventSeeder::Engine
+  const char* const engine_names[] = { "mixmax", "ranlux", "ranlux64", "mtwist", "ranecu", "james" };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventSeeder* EventSeeder::instance_ = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventSeeder* EventSeeder::Instance()
+{
+  // created by the master before the workers start
+  if(!instance_) instance_ = new EventSeeder();
+  return instance_;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventSeeder::EventSeeder()
+: seed_(DrawSeed()), seed_set_(false), per_event_seeding_(true), engine_(kMixMax), luxury_(-1),
+  replaying_(false), replay_run_id_(-1), replay_event_id_(-1), replay_verbose_(1),
+  messenger_(nullptr), replay_messenger_(nullptr)
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventSeeder::~EventSeeder()
+{
+  delete messenger_;
+  delete replay_messenger_;
+  instance_ = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventSeeder::DefineCommands()
+{
+  // Define /hodoscope/random/ command directory using generic messenger class
+  messenger_ 
+    = new G4GenericMessenger(this, 
+        "/hodoscope/random/", 
+        "Random number control");
+
+  // seed command
+  auto& seedCmd
+    = messenger_->DeclareMethod("seed", &EventSeeder::SetSeed,
+        "Seed of the job: the stream of every event is derived from\n"
+        "(seed, run ID, event ID). Drawn from std::random_device if not set.");
+  seedCmd.SetParameterName("seed", false);
+  seedCmd.SetRange("seed>=0");
+  seedCmd.SetStates(G4State_PreInit, G4State_Idle);
+  seedCmd.SetToBeBroadcasted(false);
+
+  // perEventSeeding command
+  auto& perEventCmd
+    = messenger_->DeclareProperty("perEventSeeding", per_event_seeding_,
+        "Reseed the engine at every event from (seed, run ID, event ID).");
+  perEventCmd.SetParameterName("flg", true);
+  perEventCmd.SetDefaultValue("true");
+  perEventCmd.SetStates(G4State_PreInit, G4State_Idle);
+  perEventCmd.SetToBeBroadcasted(false);
+
+  // engine command
+  auto& engineCmd
+    = messenger_->DeclareMethod("engine", &EventSeeder::SetEngine,
+        "Random engine of all the threads (from the next run).");
+  engineCmd.SetParameterName("engine", false);
+  engineCmd.SetCandidates("mixmax ranlux ranlux64 mtwist ranecu james");
+  engineCmd.SetStates(G4State_PreInit, G4State_Idle);
+  engineCmd.SetToBeBroadcasted(false);
+
+  // luxury command
+  auto& luxuryCmd
+    = messenger_->DeclareProperty("luxury", luxury_,
+        "Luxury level of the Ranlux engines (ranlux 0-4, ranlux64 0-2, -1: default).");
+  luxuryCmd.SetParameterName("luxury", false);
+  luxuryCmd.SetRange("luxury>=-1 && luxury<=4");
+  luxuryCmd.SetStates(G4State_PreInit, G4State_Idle);
+  luxuryCmd.SetToBeBroadcasted(false);
+
+  // replayVerbose command
+  auto& verboseCmd
+    = messenger_->DeclareProperty("replayVerbose", replay_verbose_,
+        "Tracking verbosity during /hodoscope/replay (1: every step).");
+  verboseCmd.SetParameterName("level", false);
+  verboseCmd.SetRange("level>=0");
+  verboseCmd.SetStates(G4State_PreInit, G4State_Idle);
+  verboseCmd.SetToBeBroadcasted(false);
+
+  // Define /hodoscope/ command directory using generic messenger class
+  replay_messenger_ 
+    = new G4GenericMessenger(this, 
+        "/hodoscope/", 
+        "Hodoscope simulation control");
+
+  // replay command
+  auto& replayCmd
+    = replay_messenger_->DeclareMethod("replay", &EventSeeder::Replay,
+        "Re-simulate the event <event> of the run <run> of a job with the same seed,\n"
+        "with every step recorded.");
+  replayCmd.SetParameterName(0, "run", false);
+  replayCmd.SetParameterName(1, "event", false);
+  replayCmd.SetStates(G4State_Idle);
+  replayCmd.SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventSeeder::SetEngine(const G4String& engine)
+{
+  for(auto i_engine = 0; i_engine <= kJames; ++i_engine){
+    if(engine==engine_names[i_engine]) engine_ = (Engine)i_engine;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventSeeder::InstallEngine() const
+{
+  if(thread_engine_type==engine_ && thread_engine_luxury==luxury_) return;
+
+  CLHEP::HepRandomEngine* engine = nullptr;
+  switch(engine_){
+    case kRanlux:
+      engine = new CLHEP::RanluxEngine(seed_,luxury_<0 ? 3 : luxury_);
+      break;
+    case kRanlux64:
+      engine = new CLHEP::Ranlux64Engine(seed_,luxury_<0 ? 1 : std::min(luxury_,2));
+      break;
+    case kMTwist:
+      engine = new CLHEP::MTwistEngine(seed_);
+      break;
+    case kRanecu:
+      engine = new CLHEP::RanecuEngine();
+      break;
+    case kJames:
+      engine = new CLHEP::HepJamesRandom();
+      break;
+    default:
+      engine = new CLHEP::MixMaxRng(seed_);
+      break;
+  }
+
+  // the previous engine of this thread is no longer used
+  G4Random::setTheEngine(engine);
+  delete thread_engine;
+  thread_engine = engine;
+  thread_engine_type = engine_;
+  thread_engine_luxury = luxury_;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventSeeder::SeedEvent(const G4int run_id, const G4int event_id) const
+{
+  if(!per_event_seeding_) return;
+  if(replaying_){
+    SeedStream(replay_run_id_,replay_event_id_);
+    return;
+  }
+  SeedStream(run_id,event_id);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventSeeder::SeedStream(const G4int run_id, const G4int event_id) const
+{
+  auto engine = G4Random::getTheEngine();
+  if(dynamic_cast<CLHEP::MixMaxRng*>(engine)){
+    // the four 32-bit numbers select an independent stream
+    long seeds[4] = { (long)(std::uint32_t)seed_, (long)(std::uint32_t)run_id,
+                      (long)(std::uint32_t)event_id, kEventStream };
+    engine->setSeeds(seeds,4);
+    return;
+  }
+
+  // other engines: two non-zero 31-bit seeds from a hash of the triple
+  // (zero-terminated list)
+  auto hash = Mix(Mix(Mix((std::uint64_t)(std::uint32_t)seed_)
+                        ^(std::uint32_t)run_id)^(std::uint32_t)event_id);
+  long seeds[3] = { (long)((hash&0x7fffffff)|1), (long)(((hash>>32)&0x7fffffff)|1), 0 };
+  // the second argument is the luxury level of the Ranlux engines
+  // (-1: default level), the current seeds for Ranecu
+  auto luxury = -1;
+  if(engine_==kRanlux) luxury = luxury_;
+  if(engine_==kRanlux64) luxury = std::min(luxury_,2);
+  engine->setSeeds(seeds,luxury);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventSeeder::Replay(const G4int run_id, const G4int event_id)
+{
+  if(run_id<0 || event_id<0){
+    G4ExceptionDescription msg;
+    msg << "Invalid event " << event_id << " of run " << run_id << ", nothing is replayed." << G4endl; 
+    G4Exception("EventSeeder::Replay()",
+        "Code004", JustWarning, msg);
+    return;
+  }
+
+  G4cout << "Replaying event " << event_id << " of run " << run_id
+         << " (seed " << seed_ << ")" << G4endl;
+
+  // the hodoscopes record every step of the replayed event (HodoscopeSD),
+  // their detail levels are not changed
+
+  // the outputs of the replay (g4root and columnar files) do not
+  // overwrite the ones of the job; the settings of the job are restored
+  // after the replay
+  auto ui_manager = G4UImanager::GetUIpointer();
+  auto analysisManager = G4AnalysisManager::Instance();
+  G4String file_name = analysisManager->GetFileName();
+  G4String writer_file_name = EventWriter::Instance()->GetFileName();
+  auto tracking_verbose = ui_manager->GetCurrentValues("/tracking/verbose");
+  if(tracking_verbose.empty()) tracking_verbose = "0";
+
+  std::ostringstream replay_name;
+  replay_name << "replay_run" << run_id << "_event" << event_id;
+  ui_manager->ApplyCommand("/analysis/setFileName "+replay_name.str());
+  ui_manager->ApplyCommand("/hodoscope/output/fileName "+replay_name.str());
+
+  std::ostringstream verbose;
+  verbose << "/tracking/verbose " << replay_verbose_;
+  ui_manager->ApplyCommand(verbose.str());
+
+  auto per_event_seeding = per_event_seeding_;
+  per_event_seeding_ = true;
+  replay_run_id_ = run_id;
+  replay_event_id_ = event_id;
+  replaying_ = true;
+
+  ui_manager->ApplyCommand("/run/beamOn 1");
+
+  replaying_ = false;
+  per_event_seeding_ = per_event_seeding;
+  ui_manager->ApplyCommand("/tracking/verbose "+tracking_verbose);
+  ui_manager->ApplyCommand("/analysis/setFileName "+file_name);
+  ui_manager->ApplyCommand("/hodoscope/output/fileName "+writer_file_name);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventSeeder::SetSeed(G4int seed)
+{
+  seed_ = seed;
+  seed_set_ = true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventSeeder::PrintSeeding() const
+{
+  G4cout << "Random engine: " << G4Random::getTheEngine()->name();
+  if(luxury_>=0 && (engine_==kRanlux || engine_==kRanlux64)) G4cout << " (luxury " << luxury_ << ")";
+  G4cout << G4endl;
+  G4cout << "Random seed: " << seed_;
+  if(per_event_seeding_) G4cout << " (reseeded at every event from seed, run ID and event ID)";
+  G4cout << G4endl;
+  if(!seed_set_){
+    G4cout << "  drawn from std::random_device: /hodoscope/random/seed " << seed_
+           << " (or -s " << seed_ << ") reproduces this job" << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
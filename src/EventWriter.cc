@@ -0,0 +1,489 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file EventWriter.cc
+/// \brief Implementation of the EventWriter class
+
+#include "EventWriter.hh"
+#include "EventRecordQueue.hh"
+#include "Analysis.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+
+  // file of this worker (per-worker files)
+  G4ThreadLocal ColumnarWriter* worker_file = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventWriter* EventWriter::instance_ = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventWriter* EventWriter::Instance()
+{
+  // created by the master before the workers start
+  if(!instance_) instance_ = new EventWriter();
+  return instance_;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventWriter::EventWriter()
+: enabled_(false), queue_size_(1024), file_name_("hodoscope"),
+  codec_(Columnar::kNone), codec_level_(0), chunk_rows_(65536),
+  root_codec_level_(1),
+  per_worker_files_(false), run_id_(-1),
+  queue_(nullptr), free_records_(nullptr), running_(false),
+  total_pushed_(0), total_stalls_(0), stall_nanoseconds_(0),
+  depth_sum_(0), max_depth_(0), total_recycled_(0),
+  write_nanoseconds_(0), compress_nanoseconds_(0), raw_bytes_(0), stored_bytes_(0),
+  total_written_(0), total_failed_files_(0), busy_seconds_(0.),
+  messenger_(nullptr)
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventWriter::~EventWriter()
+{
+  Close();
+  delete messenger_;
+  instance_ = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventWriter::DefineCommands()
+{
+  // Define /hodoscope/output/ command directory using generic messenger class
+  messenger_ 
+    = new G4GenericMessenger(this, 
+        "/hodoscope/output/", 
+        "Output control");
+
+  // asyncWriter command
+  auto& asyncCmd
+    = messenger_->DeclareProperty("asyncWriter", enabled_,
+        "Write the event records from a dedicated thread instead of the event tree.");
+  asyncCmd.SetParameterName("flg", true);
+  asyncCmd.SetDefaultValue("true");
+  asyncCmd.SetStates(G4State_PreInit, G4State_Idle);
+  asyncCmd.SetToBeBroadcasted(false);
+
+  // queueSize command
+  auto& queueCmd
+    = messenger_->DeclareProperty("queueSize", queue_size_,
+        "Number of event records the queue of the asynchronous writer can hold.");
+  queueCmd.SetParameterName("size", false);
+  queueCmd.SetRange("size>0");
+  queueCmd.SetStates(G4State_PreInit, G4State_Idle);
+  queueCmd.SetToBeBroadcasted(false);
+
+  // fileName command
+  auto& fileCmd
+    = messenger_->DeclareProperty("fileName", file_name_,
+        "Base name of the files of the asynchronous writer (<name>_run<ID>.hcol).");
+  fileCmd.SetParameterName("name", false);
+  fileCmd.SetStates(G4State_PreInit, G4State_Idle);
+  fileCmd.SetToBeBroadcasted(false);
+
+  // codec command
+  auto& codecCmd
+    = messenger_->DeclareMethod("codec", &EventWriter::SetCodec,
+        "Compression of the column blocks (if built with WITH_LZ4 / WITH_ZSTD /\n"
+        "WITH_ZLIB).");
+  codecCmd.SetParameterName("codec", false);
+  codecCmd.SetCandidates("none lz4 zstd zlib");
+  codecCmd.SetStates(G4State_PreInit, G4State_Idle);
+  codecCmd.SetToBeBroadcasted(false);
+
+  // codecLevel command
+  auto& levelCmd
+    = messenger_->DeclareProperty("codecLevel", codec_level_,
+        "Compression level of the column blocks (0: default of the codec;\n"
+        "lz4 switches to LZ4HC from level 3).");
+  levelCmd.SetParameterName("level", false);
+  levelCmd.SetRange("level>=0");
+  levelCmd.SetStates(G4State_PreInit, G4State_Idle);
+  levelCmd.SetToBeBroadcasted(false);
+
+  // rootCodec command
+  auto& rootCodecCmd
+    = messenger_->DeclareMethod("rootCodec", &EventWriter::SetRootCodec,
+        "Compression of the g4root file (only zlib is supported by g4root).");
+  rootCodecCmd.SetParameterName("codec", false);
+  rootCodecCmd.SetCandidates("none lz4 zstd zlib");
+  rootCodecCmd.SetStates(G4State_PreInit, G4State_Idle);
+  rootCodecCmd.SetToBeBroadcasted(false);
+
+  // rootCodecLevel command
+  auto& rootLevelCmd
+    = messenger_->DeclareProperty("rootCodecLevel", root_codec_level_,
+        "Compression level of the g4root file (0: none, 1-9: zlib).");
+  rootLevelCmd.SetParameterName("level", false);
+  rootLevelCmd.SetRange("level>=0 && level<=9");
+  rootLevelCmd.SetStates(G4State_PreInit, G4State_Idle);
+  rootLevelCmd.SetToBeBroadcasted(false);
+
+  // chunkRows command
+  auto& chunkCmd
+    = messenger_->DeclareProperty("chunkRows", chunk_rows_,
+        "Number of events per block of each column.");
+  chunkCmd.SetParameterName("rows", false);
+  chunkCmd.SetRange("rows>0");
+  chunkCmd.SetStates(G4State_PreInit, G4State_Idle);
+  chunkCmd.SetToBeBroadcasted(false);
+
+  // perWorkerFiles command
+  auto& workerCmd
+    = messenger_->DeclareMethod("perWorkerFiles", &EventWriter::SetPerWorkerFiles,
+        "One output file per worker (columnar and g4root), without queue nor\n"
+        "ntuple merging through the master. Set it before /run/initialize.");
+  workerCmd.SetParameterName("flg", true);
+  workerCmd.SetDefaultValue("true");
+  workerCmd.SetStates(G4State_PreInit);
+  workerCmd.SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventWriter::SetPerWorkerFiles(G4bool per_worker_files)
+{
+  per_worker_files_ = per_worker_files;
+
+  // ntuple merging mode of the master (which books no ntuple); the workers
+  // take it from GetPerWorkerFiles() in their RunAction, before booking
+  if(G4Threading::IsMultithreadedApplication()){
+    G4AnalysisManager::Instance()->SetNtupleMerging(!per_worker_files_);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventWriter::SetCodec(const G4String& codec)
+{
+  auto selected = Columnar::kNone;
+  if(codec=="lz4") selected = Columnar::kLZ4;
+  else if(codec=="zstd") selected = Columnar::kZstd;
+  else if(codec=="zlib") selected = Columnar::kZlib;
+
+  if(!ColumnarWriter::IsCodecAvailable(selected)){
+    G4ExceptionDescription msg;
+    msg << "Codec " << codec << " is not built in, the blocks are not compressed." << G4endl; 
+    G4Exception("EventWriter::SetCodec()",
+        "Code004", JustWarning, msg);
+    selected = Columnar::kNone;
+  }
+  codec_ = selected;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventWriter::SetRootCodec(const G4String& codec)
+{
+  if(codec=="none"){
+    root_codec_level_ = 0;
+    return;
+  }
+  if(codec!="zlib"){
+    G4ExceptionDescription msg;
+    msg << "Codec " << codec << " is not supported by g4root, zlib is used." << G4endl; 
+    G4Exception("EventWriter::SetRootCodec()",
+        "Code004", JustWarning, msg);
+  }
+  if(root_codec_level_==0) root_codec_level_ = 1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventWriter::Open(const G4int run_id)
+{
+  if(!enabled_ || IsOpen()) return;
+
+  run_id_ = run_id;
+  total_pushed_ = 0;
+  total_stalls_ = 0;
+  stall_nanoseconds_ = 0;
+  depth_sum_ = 0;
+  max_depth_ = 0;
+  total_recycled_ = 0;
+  write_nanoseconds_ = 0;
+  compress_nanoseconds_ = 0;
+  raw_bytes_ = 0;
+  stored_bytes_ = 0;
+  total_written_ = 0;
+  total_failed_files_ = 0;
+  busy_seconds_ = 0.;
+
+  // the workers open their files on their first event
+  if(per_worker_files_){
+    running_.store(true,std::memory_order_release);
+    return;
+  }
+
+  std::ostringstream file_name;
+  file_name << file_name_ << "_run" << run_id << ".hcol";
+  OpenFile(file_,file_name.str());
+  if(!file_.IsOpen()) return;
+
+  queue_ = new EventRecordQueue(queue_size_);
+  free_records_ = new EventRecordQueue(kFreeRecords);
+  running_.store(true,std::memory_order_release);
+  thread_ = std::thread(&EventWriter::Run,this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventWriter::OpenFile(ColumnarWriter& file, const G4String& file_name)
+{
+  file.SetCodec(codec_,codec_level_);
+  file.SetChunkRows(chunk_rows_);
+
+  // same order as in Write()
+  file.ClearColumns();
+  file.DefineColumn("run_id",Columnar::kInt32);
+  file.DefineColumn("event_id",Columnar::kInt32);
+  file.DefineColumn("seed",Columnar::kInt32);
+  for(const auto& name: TrackingPlane::detector_name){
+    file.DefineColumn(name+"_nhit",Columnar::kInt32);
+    file.DefineColumn(name+"_position_x",Columnar::kFloat32);
+    file.DefineColumn(name+"_position_y",Columnar::kFloat32);
+    file.DefineColumn(name+"_position_z",Columnar::kFloat32);
+    file.DefineColumn(name+"_momentum_x",Columnar::kFloat32);
+    file.DefineColumn(name+"_momentum_y",Columnar::kFloat32);
+    file.DefineColumn(name+"_momentum_z",Columnar::kFloat32);
+  }
+  for(const auto& name: Hodoscope::detector_name){
+    file.DefineColumn(name+"_nseg",Columnar::kInt32);
+    file.DefineColumn(name+"_segment_id",Columnar::kInt32);
+    file.DefineColumn(name+"_energy_deposit",Columnar::kFloat32);
+    file.DefineColumn(name+"_time",Columnar::kFloat32);
+    file.DefineColumn(name+"_position_x",Columnar::kFloat32);
+    file.DefineColumn(name+"_position_y",Columnar::kFloat32);
+    file.DefineColumn(name+"_position_z",Columnar::kFloat32);
+  }
+
+  if(!file.Open(file_name)){
+    G4ExceptionDescription msg;
+    msg << "Cannot open " << file_name << ", no event record is written." << G4endl; 
+    G4Exception("EventWriter::OpenFile()",
+        "Code004", JustWarning, msg);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventWriter::Close()
+{
+  if(!IsOpen()) return;
+
+  // the workers are done: the writer drains the queue and stops
+  running_.store(false,std::memory_order_release);
+  if(!thread_.joinable()) return;
+  thread_.join();
+  if(!file_.Close()) ReportWriteError();
+
+  delete queue_;
+  queue_ = nullptr;
+  delete free_records_;
+  free_records_ = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventWriter::CloseWorkerFile()
+{
+  if(!worker_file) return;
+  if(!worker_file->Close()) ReportWriteError();
+  compress_nanoseconds_ += (G4long)(worker_file->GetCompressSeconds()*1.e9);
+  raw_bytes_ += worker_file->GetRawBytes();
+  stored_bytes_ += worker_file->GetStoredBytes();
+  delete worker_file;
+  worker_file = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventWriter::ReportWriteError()
+{
+  total_failed_files_++;
+  G4ExceptionDescription msg;
+  msg << "Write error on a columnar file of run " << run_id_
+      << " (e.g. disk full), the file is incomplete." << G4endl; 
+  G4Exception("EventWriter::Close()",
+      "Code004", JustWarning, msg);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventWriter::Push(EventRecord& record)
+{
+  if(per_worker_files_){
+    if(!worker_file){
+      std::ostringstream file_name;
+      file_name << file_name_ << "_run" << run_id_ 
+                << "_t" << std::max(G4Threading::G4GetThreadId(),0) << ".hcol";
+      worker_file = new ColumnarWriter();
+      OpenFile(*worker_file,file_name.str());
+    }
+    total_pushed_++;
+    if(!worker_file->IsOpen()) return;
+    auto start = Clock::now();
+    Write(*worker_file,record);
+    write_nanoseconds_
+      += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now()-start).count();
+    return;
+  }
+
+  auto depth = (G4long)queue_->GetDepth();
+  depth_sum_ += depth;
+  auto max_depth = max_depth_.load(std::memory_order_relaxed);
+  while(depth>max_depth && 
+      !max_depth_.compare_exchange_weak(max_depth,depth,std::memory_order_relaxed)) {}
+
+  total_pushed_++;
+  if(!queue_->TryPush(record)){
+    // back-pressure: the writer is behind, wait for a free cell
+    auto start = Clock::now();
+    while(!queue_->TryPush(record)) std::this_thread::yield();
+    total_stalls_++;
+    stall_nanoseconds_ += 
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now()-start).count();
+  }
+
+  // the vectors of the record were moved out: take back a drained record
+  // (its contents are cleared by the event action)
+  if(free_records_->TryPop(record)) total_recycled_++;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventWriter::Run()
+{
+  EventRecord record;
+  for(;;){
+    if(queue_->TryPop(record)){
+      auto start = Clock::now();
+      Write(file_,record);
+      // recycled by the workers (dropped if the free list is full)
+      free_records_->TryPush(record);
+      busy_seconds_ += std::chrono::duration<G4double>(Clock::now()-start).count();
+      continue;
+    }
+    // empty: stop once the run is over, otherwise wait for the workers
+    if(!running_.load(std::memory_order_acquire)){
+      if(queue_->GetDepth()==0) break;
+      continue;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventWriter::Write(ColumnarWriter& file, const EventRecord& record)
+{
+  // no Geant4 service (G4cout, G4Exception) is used from the writer thread
+  std::uint32_t column = 0;
+  file.Fill(column++,&record.run_id,1);
+  file.Fill(column++,&record.event_id,1);
+  file.Fill(column++,&record.seed,1);
+
+  for(const auto& plane: record.tracking_planes){
+    file.Fill(column++,&plane.total_hits,1);
+    file.Fill(column++,&plane.position_x,1);
+    file.Fill(column++,&plane.position_y,1);
+    file.Fill(column++,&plane.position_z,1);
+    file.Fill(column++,&plane.momentum_x,1);
+    file.Fill(column++,&plane.momentum_y,1);
+    file.Fill(column++,&plane.momentum_z,1);
+  }
+
+  for(const auto& columns: record.hodoscopes){
+    auto total_segments = (G4int)columns.segment_id.size();
+    file.Fill(column++,&total_segments,1);
+    file.Fill(column++,columns.segment_id.data(),total_segments);
+    file.Fill(column++,columns.energy_deposit.data(),total_segments);
+    file.Fill(column++,columns.time.data(),total_segments);
+    file.Fill(column++,columns.position_x.data(),total_segments);
+    file.Fill(column++,columns.position_y.data(),total_segments);
+    file.Fill(column++,columns.position_z.data(),total_segments);
+  }
+  file.EndRow();
+
+  total_written_++;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventWriter::PrintStatistics() const
+{
+  if(!enabled_) return;
+
+  auto total_pushed = total_pushed_.load();
+  G4cout << "-------------------------------------" << G4endl;
+  if(total_failed_files_>0){
+    G4cout << " WRITE ERRORS      : " << total_failed_files_.load()
+           << " incomplete file(s)" << G4endl;
+  }
+  if(per_worker_files_){
+    G4cout << " per-worker files" << G4endl;
+    G4cout << " records written   : " << total_written_.load() << " / " << total_pushed << G4endl;
+    G4cout << " bytes (raw/file)  : " << raw_bytes_.load() << " / "
+           << stored_bytes_.load() << G4endl;
+    G4cout << " worker write time : " << write_nanoseconds_.load()*1.e-9 << " s (compression "
+           << compress_nanoseconds_.load()*1.e-9 << " s)" << G4endl;
+    G4cout << "-------------------------------------" << G4endl;
+    return;
+  }
+  G4cout << " asynchronous writer (queue of " << queue_size_ << " records)" << G4endl;
+  G4cout << " records written   : " << total_written_.load() << " / " << total_pushed << G4endl;
+  G4cout << " bytes (raw/file)  : " << file_.GetRawBytes() << " / "
+         << file_.GetStoredBytes() << G4endl;
+  G4cout << " writer busy time  : " << busy_seconds_ << " s (compression "
+         << file_.GetCompressSeconds() << " s)" << G4endl;
+  if(total_pushed>0){
+    G4cout << " mean queue depth  : " << (G4double)depth_sum_.load()/total_pushed << G4endl;
+  }
+  G4cout << " max. queue depth  : " << max_depth_.load() << G4endl;
+  G4cout << " recycled records  : " << total_recycled_.load() << " / " << total_pushed << G4endl;
+  G4cout << " worker stalls     : " << total_stalls_.load() << " ("
+         << stall_nanoseconds_.load()*1.e-9 << " s)" << G4endl;
+  G4cout << "-------------------------------------" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -45,12 +45,17 @@
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 G4ThreadLocal G4Allocator<HodoscopeHit>* HodoscopeHitAllocator;
+G4ThreadLocal G4Allocator<HodoscopeHitsCollection>* HodoscopeHitsCollectionAllocator;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 HodoscopeHit::HodoscopeHit()
 : G4VHit(), 
-  segment_id_(-1), logical_(nullptr), position_(0), total_hits_(0)
+  segment_id_(-1), logical_(nullptr), position_(0), total_hits_(0),
+  total_energy_deposit_(0.), first_hit_time_(0.),
+  multiplicity_(0), last_track_id_(-1), weighted_position_sum_(0),
+  step_store_(nullptr), first_row_(-1), last_row_(-1),
+  last_energy_deposit_(0.)
 {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -67,16 +72,16 @@ HodoscopeHit::HodoscopeHit(const HodoscopeHit &right)
   position_(right.position_),
   rotation_(right.rotation_),
   total_hits_(right.total_hits_),
-
-  track_id_(right.track_id_),
-  parent_id_(right.parent_id_),
-  particle_id_(right.particle_id_),
-  hit_time_(right.hit_time_),
-  energy_deposit_(right.energy_deposit_),
-  local_position_(right.local_position_),
-  global_position_(right.global_position_),
-  momentum_(right.momentum_),
-  polarization_(right.polarization_)
+  total_energy_deposit_(right.total_energy_deposit_),
+  first_hit_time_(right.first_hit_time_),
+  multiplicity_(right.multiplicity_),
+  last_track_id_(right.last_track_id_),
+  weighted_position_sum_(right.weighted_position_sum_),
+
+  step_store_(right.step_store_),
+  first_row_(right.first_row_),
+  last_row_(right.last_row_),
+  last_energy_deposit_(right.last_energy_deposit_)
 {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -88,16 +93,16 @@ const HodoscopeHit& HodoscopeHit::operator=(const HodoscopeHit &right)
   position_ = right.position_;
   rotation_ = right.rotation_;
   total_hits_ = right.total_hits_;
+  total_energy_deposit_ = right.total_energy_deposit_;
+  first_hit_time_ = right.first_hit_time_;
+  multiplicity_ = right.multiplicity_;
+  last_track_id_ = right.last_track_id_;
+  weighted_position_sum_ = right.weighted_position_sum_;
 
-  track_id_ = right.track_id_;
-  parent_id_ = right.parent_id_;
-  particle_id_ = right.particle_id_;
-  hit_time_ = right.hit_time_;
-  energy_deposit_ = right.energy_deposit_;
-  local_position_ = right.local_position_;
-  global_position_ = right.global_position_;
-  momentum_ = right.momentum_;
-  polarization_ = right.polarization_;
+  step_store_ = right.step_store_;
+  first_row_ = right.first_row_;
+  last_row_ = right.last_row_;
+  last_energy_deposit_ = right.last_energy_deposit_;
 
   return *this;
 }
@@ -118,8 +123,8 @@ void HodoscopeHit::Draw()
   G4VisAttributes attributes;
 
   // hit point
-  for(auto hit_position: global_position_){
-    G4Circle circle(hit_position);
+  for(const auto& hit_position: GetGlobalPosition()){
+    G4Circle circle(static_cast<G4ThreeVector>(hit_position));
     circle.SetScreenSize(10);
     circle.SetFillStyle(G4Circle::filled);
     attributes.SetColour(MyColour::Hit());
@@ -187,7 +192,26 @@ void HodoscopeHit::Print()
   G4cout << "-------------------------------------" << G4endl;
   G4cout << " segment    : " << segment_id_ << G4endl;
   G4cout << " total hits : " << total_hits_ << G4endl;
+  G4cout << " energy     : " << G4BestUnit(total_energy_deposit_,"Energy") << G4endl;
+  G4cout << " first time : " << G4BestUnit(first_hit_time_,"Time") << G4endl;
+  G4cout << " tracks     : " << multiplicity_ << G4endl;
+  G4cout << " position   : " << G4BestUnit(GetWeightedPosition(),"Length") << G4endl;
   G4cout << "-------------------------------------" << G4endl;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+HodoscopeHitsCollection::HodoscopeHitsCollection(G4String detector_name, G4String collection_name)
+: G4THitsCollection<HodoscopeHit>(detector_name,collection_name),
+  step_store_(HodoscopeStepStore::Acquire())
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+HodoscopeHitsCollection::~HodoscopeHitsCollection()
+{
+  // the hits deleted by the base class do not access the store
+  HodoscopeStepStore::Release(step_store_);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
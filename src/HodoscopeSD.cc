@@ -29,27 +29,122 @@
 
 #include "HodoscopeSD.hh"
 #include "HodoscopeHit.hh"
+#include "EventSeeder.hh"
 
 #include "G4HCofThisEvent.hh"
 #include "G4TouchableHistory.hh"
 #include "G4Track.hh"
 #include "G4Step.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
 #include "G4SDManager.hh"
+#include "G4GenericMessenger.hh"
 #include "G4ios.hh"
 
+#include <cfloat>
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 HodoscopeSD::HodoscopeSD(G4String name)
 : G4VSensitiveDetector(name), 
-  hits_collection_(nullptr), hits_collection_id_(-1)
+  hits_collection_(nullptr), hits_collection_id_(-1),
+  total_segments_high_water_(0),
+  messenger_(nullptr), detail_level_(kStep), merge_steps_(false),
+  event_detail_level_(kStep), event_merge_steps_(false),
+  energy_threshold_(0.), time_window_(DBL_MAX),
+  total_steps_(0), total_records_(0)
 {
   collectionName.insert("hodoscope_hitscollection");
+
+  // define commands for this class
+  DefineCommands();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 HodoscopeSD::~HodoscopeSD()
-{}
+{
+  delete messenger_;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HodoscopeSD::SetDetailLevel(const G4String& level)
+{
+  if(level=="summary") detail_level_ = kSummary;
+  else if(level=="track") detail_level_ = kTrack;
+  else if(level=="step") detail_level_ = kStep;
+  else if(level=="entry") detail_level_ = kEntry;
+  else{
+    G4ExceptionDescription msg;
+    msg << "Unknown detail level " << level << "." << G4endl; 
+    G4Exception("HodoscopeSD::SetDetailLevel()",
+        "Code003", JustWarning, msg);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HodoscopeSD::DefineCommands()
+{
+  // Define /hodoscope/sd/<name>/ command directory using generic messenger class
+  messenger_ 
+    = new G4GenericMessenger(this, 
+        "/hodoscope/sd/"+SensitiveDetectorName+"/", 
+        "Hodoscope sensitive detector control");
+
+  // detail command
+  auto& detailCmd
+    = messenger_->DeclareMethod("detail", &HodoscopeSD::SetDetailLevel);
+  G4String guidance
+    = "Recording level of the hits.\n";
+  guidance
+    += "  summary : energy deposit, first time, multiplicity and position per segment only\n";
+  guidance
+    += "  track   : one merged step per track and segment, no local position\n";
+  guidance
+    += "  step    : every step with all the quantities\n";
+  guidance
+    += "  entry   : one step per track entering a segment, no energy deposit";
+  detailCmd.SetGuidance(guidance);
+  detailCmd.SetParameterName("level", false);
+  detailCmd.SetCandidates("summary track step entry");
+  detailCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  // mergeSteps command
+  auto& mergeCmd
+    = messenger_->DeclareProperty("mergeSteps", merge_steps_);
+  guidance
+    = "Boolean flag for merging the consecutive steps of a track in a segment\n";
+  guidance
+    += "into one step at step level: the energy deposits are summed, the time,\n";
+  guidance
+    += "entry position and momentum are the ones of the first step, and the exit\n";
+  guidance
+    += "position the one of the last step. Always done at track level.";
+  mergeCmd.SetGuidance(guidance);
+  mergeCmd.SetParameterName("flg", true);
+  mergeCmd.SetDefaultValue("true");
+  mergeCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  // energyThreshold command
+  auto& thresholdCmd
+    = messenger_->DeclarePropertyWithUnit("energyThreshold", "keV", energy_threshold_,
+        "Steps with an energy deposit not above the threshold are not recorded\n"
+        "(not applied at entry level).");
+  thresholdCmd.SetParameterName("threshold", true);
+  thresholdCmd.SetRange("threshold>=0.");
+  thresholdCmd.SetDefaultValue("0.");
+  thresholdCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  // timeWindow command
+  auto& timeCmd
+    = messenger_->DeclarePropertyWithUnit("timeWindow", "ns", time_window_,
+        "Steps starting later than the time window (global time) are not recorded.");
+  timeCmd.SetParameterName("window", false);
+  timeCmd.SetRange("window>0.");
+  timeCmd.SetStates(G4State_PreInit, G4State_Idle);
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -57,77 +152,240 @@ void HodoscopeSD::Initialize(G4HCofThisEvent* collection)
 {
   hits_collection_
     = new HodoscopeHitsCollection(SensitiveDetectorName,collectionName[0]);
+  // reserve the hit pointers for the largest event seen so far
+  hits_collection_->GetVector()->reserve(total_segments_high_water_);
 
   if (hits_collection_id_<0) { 
     hits_collection_id_ = G4SDManager::GetSDMpointer()->GetCollectionID(hits_collection_); 
   }
   collection->AddHitsCollection(hits_collection_id_,hits_collection_);
+
+  // a replayed event records every step, whatever the selected level
+  auto replaying = EventSeeder::Instance()->IsReplaying();
+  event_detail_level_ = replaying ? kStep : detail_level_;
+  event_merge_steps_ = replaying ? false : merge_steps_;
+
+  // reset only the segments filled in the previous event
+  for(auto segment_id: hit_segments_){
+    segment_hit_index_[segment_id] = -1;
+  }
+  hit_segments_.clear();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 G4bool HodoscopeSD::ProcessHits(G4Step* step, G4TouchableHistory*)
 {
+  total_steps_++;
+  if(event_detail_level_==kEntry) return ProcessEntry(step);
+
   auto energy_deposit = step->GetTotalEnergyDeposit();
-  if(energy_deposit==0.) return true;
+  if(energy_deposit<=energy_threshold_) return true;
 
-  auto track = step->GetTrack();
   auto pre_steppoint = step->GetPreStepPoint();
+  auto hit_time = pre_steppoint->GetGlobalTime();
+  if(hit_time>time_window_) return true;
+
   auto touchable = pre_steppoint->GetTouchable();
-  auto physical = touchable->GetVolume(0);
-  auto transform = touchable->GetHistory()->GetTopTransform();
-  auto logical = physical->GetLogicalVolume();
+  auto segment_id = touchable->GetVolume(0)->GetCopyNo();
+  auto hit = GetHit(segment_id,touchable);
+  if(!hit) return false;
 
+  auto track = step->GetTrack();
   auto track_id = track->GetTrackID();
+  auto global_position = pre_steppoint->GetPosition();
+
+  auto new_track = hit->AccumulateStep(track_id,energy_deposit,hit_time,global_position);
+  if(event_detail_level_==kSummary) return true;
+
+  // merge the consecutive steps of a track in a segment into one
+  auto exit_position = step->GetPostStepPoint()->GetPosition();
+  if((event_detail_level_==kTrack || event_merge_steps_) && !new_track){
+    hit->MergeLastStep(energy_deposit,exit_position);
+    return true;
+  }
+
   auto parent_id = track->GetParentID();
   auto particle_id = track->GetParticleDefinition()->GetPDGEncoding();
-  auto segment_id = physical->GetCopyNo();
+  auto momentum = pre_steppoint->GetMomentum();
+  G4ThreeVector local_position(0);
+  G4ThreeVector polarization(0);
+  if(event_detail_level_==kStep){
+    auto& placement = GetSegmentPlacement(segment_id,touchable);
+    local_position = placement.global_to_local.TransformPoint(global_position);
+    polarization = track->GetPolarization();
+  }
+
+  hit->PushStep(track_id, parent_id, particle_id, hit_time, energy_deposit,
+      local_position, global_position, exit_position, momentum, polarization);
+  total_records_++;
+
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool HodoscopeSD::ProcessEntry(G4Step* step)
+{
+  // only the steps entering the segment through its boundary
+  auto pre_steppoint = step->GetPreStepPoint();
+  if(pre_steppoint->GetStepStatus()!=fGeomBoundary) return true;
+
   auto hit_time = pre_steppoint->GetGlobalTime();
+  if(hit_time>time_window_) return true;
+
+  auto touchable = pre_steppoint->GetTouchable();
+  auto segment_id = touchable->GetVolume(0)->GetCopyNo();
+  auto hit = GetHit(segment_id,touchable);
+  if(!hit) return false;
+
+  // once per track and segment
+  auto track = step->GetTrack();
+  auto track_id = track->GetTrackID();
+  if(hit->HasTrack(track_id)) return true;
+
   auto global_position = pre_steppoint->GetPosition();
-  auto local_position = transform.TransformPoint(global_position);
+  hit->AccumulateStep(track_id,0.,hit_time,global_position);
+
+  auto parent_id = track->GetParentID();
+  auto particle_id = track->GetParticleDefinition()->GetPDGEncoding();
   auto momentum = pre_steppoint->GetMomentum();
-  auto polarization = track->GetPolarization();
-
-  auto position = transform.NetTranslation();
-  auto rotation = transform.NetRotation();
-
-  G4bool segment_has_hit = false;
-  for(auto i_hit=0; i_hit<hits_collection_->entries(); i_hit++){
-    auto hit = (*hits_collection_)[i_hit];
-    if(hit->GetSegmentID()==segment_id){
-      segment_has_hit = true;
-      hit->PushTotalHits();
-      hit->PushTrackID(track_id);
-      hit->PushParentID(parent_id);
-      hit->PushParticleID(particle_id);
-      hit->PushHitTime(hit_time);
-      hit->PushEnergyDeposit(energy_deposit);
-      hit->PushGlobalPosition(global_position);
-      hit->PushLocalPosition(local_position);
-      hit->PushMomentum(momentum);
-      hit->PushPolarization(polarization);
-    }
+  hit->PushStep(track_id, parent_id, particle_id, hit_time, 0.,
+      G4ThreeVector(0), global_position, global_position, momentum, G4ThreeVector(0));
+  total_records_++;
+
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+HodoscopeHit* HodoscopeSD::GetHit(const G4int segment_id,
+    const G4VTouchable* touchable)
+{
+  if(segment_id<0){
+    G4ExceptionDescription msg;
+    msg << "Negative copy number " << segment_id
+        << " in " << touchable->GetVolume(0)->GetName() << "." << G4endl; 
+    G4Exception("HodoscopeSD::ProcessHits()",
+        "Code003", JustWarning, msg);
+    return nullptr;
+  }
+  if(segment_id>=(G4int)segment_hit_index_.size()){
+    segment_hit_index_.resize(segment_id+1,-1);
   }
+
   // if there is no hit in the segment, create new hit.
-  if(!segment_has_hit){
-    auto hit = new HodoscopeHit();
-    hit->SetSegmentID(segment_id);
-    hit->SetLogicalVolume(logical);
-    hit->SetPosition(position);
-    hit->SetRotation(rotation);
-    hit->PushTotalHits();
-    hit->PushTrackID(track_id);
-    hit->PushParentID(parent_id);
-    hit->PushParticleID(particle_id);
-    hit->PushHitTime(hit_time);
-    hit->PushEnergyDeposit(energy_deposit);
-    hit->PushGlobalPosition(global_position);
-    hit->PushLocalPosition(local_position);
-    hit->PushMomentum(momentum);
-    hit->PushPolarization(polarization);
-    hits_collection_->insert(hit);
+  auto hit_index = segment_hit_index_[segment_id];
+  if(hit_index>=0) return (*hits_collection_)[hit_index];
+
+  auto& placement = GetSegmentPlacement(segment_id,touchable);
+  auto hit = new HodoscopeHit();
+  hit->SetSegmentID(segment_id);
+  hit->SetLogicalVolume(touchable->GetVolume(0)->GetLogicalVolume());
+  hit->SetPosition(placement.position);
+  hit->SetRotation(placement.rotation);
+  hit->SetStepStore(hits_collection_->GetStepStore());
+  segment_hit_index_[segment_id] = hits_collection_->insert(hit)-1;
+  hit_segments_.push_back(segment_id);
+  return hit;
+}
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HodoscopeSD::EndOfEvent(G4HCofThisEvent*)
+{
+  auto total_segments = hits_collection_->entries();
+  if(total_segments>total_segments_high_water_){
+    total_segments_high_water_ = total_segments;
   }
 
-  return true;
+  // make the steps of each hit contiguous in the store, unless the hits
+  // were not interleaved during the event
+  auto store = hits_collection_->GetStepStore();
+  if(store->IsCompacted()) return;
+
+  store->BeginCompaction();
+  for(size_t i_hit=0; i_hit<total_segments; i_hit++){
+    (*hits_collection_)[i_hit]->Compact();
+  }
+  store->EndCompaction();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HodoscopeSD::CacheSegmentPlacements(const G4VPhysicalVolume* world)
+{
+  segment_placements_.clear();
+  CacheSegmentPlacements(world->GetLogicalVolume(),G4AffineTransform());
 }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HodoscopeSD::CacheSegmentPlacements(const G4LogicalVolume* mother,
+    const G4AffineTransform& mother_global_to_local)
+{
+  for(size_t i_daughter=0; i_daughter<mother->GetNoDaughters(); i_daughter++){
+    auto daughter = mother->GetDaughter(i_daughter);
+    // replicated segments are cached on their first hit
+    if(daughter->IsReplicated()) continue;
+
+    // same composition as G4NavigationLevelRep
+    G4AffineTransform relative(daughter->GetRotation(),daughter->GetTranslation());
+    G4AffineTransform global_to_local;
+    global_to_local.InverseProduct(mother_global_to_local,relative);
+
+    auto logical = daughter->GetLogicalVolume();
+    if(logical->GetSensitiveDetector()==this){
+      auto segment_id = daughter->GetCopyNo();
+      if(segment_id<0) continue;
+      if(segment_id>=(G4int)segment_placements_.size()){
+        segment_placements_.resize(segment_id+1);
+      }
+      auto& placement = segment_placements_[segment_id];
+      if(placement.state==SegmentPlacement::kCached){
+        G4ExceptionDescription msg;
+        msg << "Copy number " << segment_id << " of " << logical->GetName()
+            << " is placed more than once, its transform is not cached." << G4endl; 
+        G4Exception("HodoscopeSD::CacheSegmentPlacements()",
+            "Code003", JustWarning, msg);
+        placement.state = SegmentPlacement::kAmbiguous;
+      }
+      else if(placement.state==SegmentPlacement::kEmpty){
+        SetPlacement(placement,global_to_local);
+      }
+    }
+
+    CacheSegmentPlacements(logical,global_to_local);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HodoscopeSD::SetPlacement(SegmentPlacement& placement,
+    const G4AffineTransform& global_to_local)
+{
+  auto local_to_global = global_to_local.Inverse();
+  placement.global_to_local = global_to_local;
+  placement.position = local_to_global.NetTranslation();
+  placement.rotation = local_to_global.NetRotation();
+  if(placement.state==SegmentPlacement::kEmpty){
+    placement.state = SegmentPlacement::kCached;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const HodoscopeSD::SegmentPlacement& HodoscopeSD::GetSegmentPlacement(
+    const G4int segment_id, const G4VTouchable* touchable)
+{
+  if(segment_id>=(G4int)segment_placements_.size()){
+    segment_placements_.resize(segment_id+1);
+  }
+  auto& placement = segment_placements_[segment_id];
+  if(placement.state==SegmentPlacement::kCached) return placement;
+
+  // not placed directly (replica) or ambiguous copy number: use the touchable
+  SetPlacement(placement,touchable->GetHistory()->GetTopTransform());
+  return placement;
+}
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,323 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file HodoscopeStepStore.cc
+/// \brief Implementation of the HodoscopeStepStore class
+
+#include "HodoscopeStepStore.hh"
+
+#include "G4SystemOfUnits.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <cmath>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+
+  // recycled stores of this thread
+  G4ThreadLocal std::vector<HodoscopeStepStore*>* free_stores = nullptr;
+
+  // capacity of the acquired stores, set from the high-water mark
+  // of rows of the previous run
+  G4ThreadLocal G4int reserved_rows = 0;
+  G4ThreadLocal G4int rows_high_water = 0;
+
+  // statistics of this thread, accumulated on Release()
+  G4ThreadLocal G4long released_stores = 0;
+  G4ThreadLocal G4long released_rows = 0;
+  G4ThreadLocal G4long released_reallocations = 0;
+
+
+#ifdef COMPACT_HODOSCOPE_STEPS
+  // largest absolute differences between the stored single-precision
+  // values and the double-precision values of the steps
+  G4ThreadLocal G4double max_time_loss = 0.;
+  G4ThreadLocal G4double max_energy_deposit_loss = 0.;
+  G4ThreadLocal G4double max_local_position_loss = 0.;
+  G4ThreadLocal G4double max_global_position_loss = 0.;
+  G4ThreadLocal G4double max_momentum_loss = 0.;
+
+  inline G4double MaxDifference(const G4ThreeVector& a, const G4ThreeVector& b)
+  {
+    return std::max(std::fabs(a.x()-b.x()),
+        std::max(std::fabs(a.y()-b.y()),std::fabs(a.z()-b.z())));
+  }
+#endif
+
+  // release the memory of a column above the given capacity
+  template <class T>
+  void ShrinkColumn(std::vector<T>& column, const G4int capacity)
+  {
+    if(column.capacity()<=(size_t)capacity) return;
+    std::vector<T>().swap(column);
+    column.reserve(capacity);
+  }
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+HodoscopeStepStore::HodoscopeStepStore()
+: compacted_(true), reallocations_(0), scratch_(nullptr)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+HodoscopeStepStore::~HodoscopeStepStore()
+{
+  delete scratch_;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+HodoscopeStepStore* HodoscopeStepStore::Acquire()
+{
+  HodoscopeStepStore* store = nullptr;
+  if(free_stores && !free_stores->empty()){
+    store = free_stores->back();
+    free_stores->pop_back();
+  }
+  else{
+    store = new HodoscopeStepStore();
+  }
+  store->Reserve(reserved_rows);
+  return store;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HodoscopeStepStore::Release(HodoscopeStepStore* store)
+{
+  if(!store) return;
+
+  auto total_rows = store->GetTotalRows();
+  if(total_rows>rows_high_water) rows_high_water = total_rows;
+
+  released_stores++;
+  released_rows += total_rows;
+  released_reallocations += store->reallocations_;
+
+  store->Clear();
+  if(!free_stores){
+    free_stores = new std::vector<HodoscopeStepStore*>;
+  }
+  free_stores->push_back(store);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HodoscopeStepStore::TrimPool()
+{
+  // the next run starts with the capacity needed by this one
+  reserved_rows = rows_high_water;
+  rows_high_water = 0;
+
+  if(!free_stores) return;
+  for(auto store: *free_stores){
+    store->Shrink(reserved_rows);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HodoscopeStepStore::PrintStatistics()
+{
+  if(released_stores==0) return;
+
+  G4cout << "-------------------------------------" << G4endl;
+  G4cout << " hodoscope step store" << G4endl;
+  G4cout << " hits collections      : " << released_stores << G4endl;
+  G4cout << " steps / collection    : "
+         << (G4double)released_rows/released_stores << G4endl;
+  G4cout << " steps high-water mark : " << rows_high_water << G4endl;
+  G4cout << " column reallocations  : " << released_reallocations
+         << " (" << (G4double)released_reallocations/released_stores
+         << " / collection)" << G4endl;
+#ifdef COMPACT_HODOSCOPE_STEPS
+  G4cout << " single-precision loss (max. absolute difference to double)" << G4endl;
+  G4cout << "   time           : " << max_time_loss/ns << " ns" << G4endl;
+  G4cout << "   energy deposit : " << max_energy_deposit_loss/keV << " keV" << G4endl;
+  G4cout << "   local position : " << max_local_position_loss/um << " um" << G4endl;
+  G4cout << "   global position: " << max_global_position_loss/um << " um" << G4endl;
+  G4cout << "   momentum       : " << max_momentum_loss/keV << " keV/c" << G4endl;
+  max_time_loss = 0.;
+  max_energy_deposit_loss = 0.;
+  max_local_position_loss = 0.;
+  max_global_position_loss = 0.;
+  max_momentum_loss = 0.;
+#endif
+  G4cout << "-------------------------------------" << G4endl;
+
+  released_stores = 0;
+  released_rows = 0;
+  released_reallocations = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HodoscopeStepStore::BeginCompaction()
+{
+  if(!scratch_){
+    scratch_ = new HodoscopeStepStore();
+  }
+  scratch_->Clear();
+  scratch_->Reserve(GetTotalRows());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int HodoscopeStepStore::CompactChain(const G4int first_row)
+{
+  auto new_first_row = scratch_->GetTotalRows();
+  auto previous_row = -1;
+  for(auto row=first_row; row>=0; row=next_row_[row]){
+    previous_row = scratch_->AppendRow(previous_row,
+        track_id_[row], parent_id_[row], particle_id_[row],
+        hit_time_[row], energy_deposit_[row],
+        local_position_[row], global_position_[row], exit_position_[row],
+        momentum_[row], polarization_[row]);
+  }
+  return new_first_row;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HodoscopeStepStore::EndCompaction()
+{
+  SwapColumns(*scratch_);
+  reallocations_ += scratch_->reallocations_;
+  scratch_->Clear();
+  compacted_ = true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HodoscopeStepStore::Clear()
+{
+  next_row_.clear();
+  track_id_.clear();
+  parent_id_.clear();
+  particle_id_.clear();
+  hit_time_.clear();
+  energy_deposit_.clear();
+  local_position_.clear();
+  global_position_.clear();
+  exit_position_.clear();
+  momentum_.clear();
+  polarization_.clear();
+
+  compacted_ = true;
+  reallocations_ = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HodoscopeStepStore::Reserve(const G4int total_rows)
+{
+  if(track_id_.capacity()>=(size_t)total_rows) return;
+
+  next_row_.reserve(total_rows);
+  track_id_.reserve(total_rows);
+  parent_id_.reserve(total_rows);
+  particle_id_.reserve(total_rows);
+  hit_time_.reserve(total_rows);
+  energy_deposit_.reserve(total_rows);
+  local_position_.reserve(total_rows);
+  global_position_.reserve(total_rows);
+  exit_position_.reserve(total_rows);
+  momentum_.reserve(total_rows);
+  polarization_.reserve(total_rows);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HodoscopeStepStore::Shrink(const G4int total_rows)
+{
+  ShrinkColumn(next_row_,total_rows);
+  ShrinkColumn(track_id_,total_rows);
+  ShrinkColumn(parent_id_,total_rows);
+  ShrinkColumn(particle_id_,total_rows);
+  ShrinkColumn(hit_time_,total_rows);
+  ShrinkColumn(energy_deposit_,total_rows);
+  ShrinkColumn(local_position_,total_rows);
+  ShrinkColumn(global_position_,total_rows);
+  ShrinkColumn(exit_position_,total_rows);
+  ShrinkColumn(momentum_,total_rows);
+  ShrinkColumn(polarization_,total_rows);
+
+  if(scratch_) scratch_->Shrink(total_rows);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HodoscopeStepStore::SwapColumns(HodoscopeStepStore& other)
+{
+  next_row_.swap(other.next_row_);
+  track_id_.swap(other.track_id_);
+  parent_id_.swap(other.parent_id_);
+  particle_id_.swap(other.particle_id_);
+  hit_time_.swap(other.hit_time_);
+  energy_deposit_.swap(other.energy_deposit_);
+  local_position_.swap(other.local_position_);
+  global_position_.swap(other.global_position_);
+  exit_position_.swap(other.exit_position_);
+  momentum_.swap(other.momentum_);
+  polarization_.swap(other.polarization_);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifdef COMPACT_HODOSCOPE_STEPS
+void HodoscopeStepStore::AccumulatePrecisionLoss(const G4int row,
+    const G4double hit_time, const G4double energy_deposit,
+    const G4ThreeVector& local_position, const G4ThreeVector& global_position,
+    const G4ThreeVector& momentum) const
+{
+  max_time_loss = std::max(max_time_loss,
+      std::fabs(hit_time_[row]-hit_time));
+  max_energy_deposit_loss = std::max(max_energy_deposit_loss,
+      std::fabs(energy_deposit_[row]-energy_deposit));
+  max_local_position_loss = std::max(max_local_position_loss,
+      MaxDifference(local_position_[row],local_position));
+  max_global_position_loss = std::max(max_global_position_loss,
+      MaxDifference(global_position_[row],global_position));
+  max_momentum_loss = std::max(max_momentum_loss,
+      MaxDifference(momentum_[row],momentum));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HodoscopeStepStore::AccumulateEnergyDepositLoss(const G4int row,
+    const G4double energy_deposit) const
+{
+  max_energy_deposit_loss = std::max(max_energy_deposit_loss,
+      std::fabs(energy_deposit_[row]-energy_deposit));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+#endif
@@ -67,6 +67,7 @@
 #include "G4HadronPhysicsQGSP_FTFP_BERT.hh"
 #include "G4HadronPhysicsQGS_BIC.hh"
 #include "G4RadioactiveDecayPhysics.hh"
+#include "G4ParallelWorldPhysics.hh"
 
 #include "G4ProcessManager.hh"
 #include "G4ParticleTypes.hh"
@@ -80,7 +81,8 @@
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo.....
 
-PhysicsList::PhysicsList() : G4VModularPhysicsList()
+PhysicsList::PhysicsList() 
+  : G4VModularPhysicsList(), fParallelWorldPhys(nullptr)
 {
   SetDefaultCutValue(0.7*CLHEP::mm);
 
@@ -106,6 +108,7 @@ PhysicsList::~PhysicsList()
   for(size_t i=0; i<fHadronPhys.size(); i++) {
     delete fHadronPhys[i];
   }
+  delete fParallelWorldPhys;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo.....
@@ -125,6 +128,8 @@ void PhysicsList::ConstructProcess()
   for(size_t i=0; i<fHadronPhys.size(); i++) {
     fHadronPhys[i]->ConstructProcess();
   }
+  // the parallel world process has to be added last
+  if(fParallelWorldPhys) fParallelWorldPhys->ConstructProcess();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo.....
@@ -273,6 +278,17 @@ void PhysicsList::AddPhysicsList(const G4String& name)
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo.....
 
+void PhysicsList::AddParallelWorld(const G4String& world_name)
+{
+  if (verboseLevel>0) {
+    G4cout << "PhysicsList::AddParallelWorld: <" << world_name << ">" << G4endl;
+  }
+  delete fParallelWorldPhys;
+  fParallelWorldPhys = new G4ParallelWorldPhysics(world_name);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo.....
+
 void PhysicsList::SetBuilderList0(G4bool flagHP)
 {
   fHadronPhys.push_back( new G4EmExtraPhysics(verboseLevel));
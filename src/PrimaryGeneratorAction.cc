@@ -28,8 +28,11 @@
 /// \brief Implementation of the PrimaryGeneratorAction class
 
 #include "PrimaryGeneratorAction.hh"
+#include "EventSeeder.hh"
 
 #include "G4Event.hh"
+#include "G4Run.hh"
+#include "G4RunManager.hh"
 #include "G4ParticleGun.hh"
 #include "G4ParticleTable.hh"
 #include "G4ParticleDefinition.hh"
@@ -72,6 +75,10 @@ PrimaryGeneratorAction::~PrimaryGeneratorAction()
 
 void PrimaryGeneratorAction::GeneratePrimaries(G4Event* event)
 {
+  // first use of the engine in the event
+  auto run_id = G4RunManager::GetRunManager()->GetCurrentRun()->GetRunID();
+  EventSeeder::Instance()->SeedEvent(run_id,event->GetEventID());
+
   G4ParticleDefinition* particle = proton_;  
   particlegun_->SetParticleDefinition(proton_);
 
@@ -0,0 +1,226 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ProgressMeter.cc
+/// \brief Implementation of the ProgressMeter class
+
+#include "ProgressMeter.hh"
+
+#include "G4GenericMessenger.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <unistd.h>
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+
+  // resident memory of the process [MB]
+  G4double GetResidentMemory()
+  {
+    std::ifstream statm("/proc/self/statm");
+    long total_pages = 0;
+    long resident_pages = 0;
+    if(!(statm >> total_pages >> resident_pages)) return 0.;
+    return resident_pages*(G4double)sysconf(_SC_PAGESIZE)/(1024.*1024.);
+  }
+
+  G4String FormatDuration(const G4double seconds)
+  {
+    auto total = (long)(seconds+0.5);
+    std::ostringstream duration;
+    duration << total/3600 << ":" << std::setfill('0') << std::setw(2) << (total/60)%60
+             << ":" << std::setw(2) << total%60;
+    return duration.str();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ProgressMeter* ProgressMeter::instance_ = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ProgressMeter* ProgressMeter::Instance()
+{
+  // created by the master before the workers start
+  if(!instance_) instance_ = new ProgressMeter();
+  return instance_;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ProgressMeter::ProgressMeter()
+: interval_(10.), total_events_(0), last_total_(0),
+  stop_(false), messenger_(nullptr)
+{
+  for(auto i_thread = 0; i_thread < kMaxThreads; ++i_thread){
+    counters_[i_thread].total_events = 0;
+    last_counts_[i_thread] = 0;
+  }
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ProgressMeter::~ProgressMeter()
+{
+  Stop();
+  delete messenger_;
+  instance_ = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ProgressMeter::DefineCommands()
+{
+  // Define /hodoscope/progress/ command directory using generic messenger class
+  messenger_ 
+    = new G4GenericMessenger(this, 
+        "/hodoscope/progress/", 
+        "Progress meter control");
+
+  // interval command
+  auto& intervalCmd
+    = messenger_->DeclareProperty("interval", interval_,
+        "Wall-clock interval of the progress reports [s] (0: no report).");
+  intervalCmd.SetParameterName("interval", false);
+  intervalCmd.SetRange("interval>=0.");
+  intervalCmd.SetStates(G4State_PreInit, G4State_Idle);
+  intervalCmd.SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ProgressMeter::Start(const G4long total_events)
+{
+  Stop();
+
+  for(auto i_thread = 0; i_thread < kMaxThreads; ++i_thread){
+    counters_[i_thread].total_events.store(0,std::memory_order_relaxed);
+    last_counts_[i_thread] = 0;
+  }
+  total_events_ = total_events;
+  last_total_ = 0;
+  start_ = Clock::now();
+
+  if(interval_<=0.) return;
+  stop_ = false;
+  thread_ = std::thread(&ProgressMeter::Run,this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ProgressMeter::Stop()
+{
+  if(!thread_.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  stop_condition_.notify_one();
+  thread_.join();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ProgressMeter::Run()
+{
+  auto interval = std::chrono::duration<G4double>(interval_);
+  auto last_report = start_;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while(!stop_condition_.wait_for(lock,interval,[this]{ return stop_; })){
+    auto now = Clock::now();
+    Report(std::chrono::duration<G4double>(now-start_).count(),
+           std::chrono::duration<G4double>(now-last_report).count());
+    last_report = now;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4long ProgressMeter::GetTotalCounted() const
+{
+  G4long total = 0;
+  for(const auto& counter: counters_){
+    total += counter.total_events.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ProgressMeter::Report(const G4double elapsed, const G4double interval)
+{
+  // rates of the threads over the interval
+  G4int total_threads = 0;
+  G4double min_rate = DBL_MAX;
+  G4double max_rate = 0.;
+  for(auto i_thread = 0; i_thread < kMaxThreads; ++i_thread){
+    auto count = counters_[i_thread].total_events.load(std::memory_order_relaxed);
+    if(count==0) continue;
+    auto rate = (count-last_counts_[i_thread])/interval;
+    last_counts_[i_thread] = count;
+    min_rate = std::min(min_rate,rate);
+    max_rate = std::max(max_rate,rate);
+    total_threads++;
+  }
+
+  auto total = GetTotalCounted();
+  auto rate = (total-last_total_)/interval;
+  auto mean_rate = elapsed>0. ? total/elapsed : 0.;
+  last_total_ = total;
+
+  // printed by this thread, not through the G4cout of a Geant4 thread
+  std::ostringstream report;
+  report << "--> " << total;
+  if(total_events_>0){
+    report << " / " << total_events_ << " events ("
+           << std::fixed << std::setprecision(1) << 100.*total/total_events_ << "%)";
+  }
+  else{
+    report << " events";
+  }
+  report.unsetf(std::ios::floatfield);
+  report << std::setprecision(4) << ", " << rate << " events/s (mean " << mean_rate << ")";
+  if(total_threads>0){
+    report << ", per thread " << rate/total_threads
+           << " [" << min_rate << ", " << max_rate << "]";
+  }
+  if(total_events_>0 && mean_rate>0.){
+    report << ", ETA " << FormatDuration((total_events_-total)/mean_rate);
+  }
+  report << ", " << std::setprecision(0) << std::fixed << GetResidentMemory() << " MB";
+  std::cout << report.str() << std::endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -28,28 +28,58 @@
 /// \brief Implementation of the RunAction class
 
 #include "RunAction.hh"
+#include "EventAction.hh"
 #include "Analysis.hh"
-
-#include "time.h"
+#include "HodoscopeStepStore.hh"
+#include "EventWriter.hh"
+#include "ProgressMeter.hh"
+#include "StepProfiler.hh"
+#include "EventSeeder.hh"
+#include "ConvergenceMonitor.hh"
+#include "HodoscopeSD.hh"
+#include "Constants.hh"
 
 #include "G4Run.hh"
+#include "G4AccumulableManager.hh"
 #include "G4RunManager.hh"
+#include "G4SDManager.hh"
+#include "G4Timer.hh"
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-RunAction::RunAction()
- : G4UserRunAction()
+RunAction::RunAction(EventAction* event_action)
+ : G4UserRunAction(), event_action_(event_action), timer_(new G4Timer),
+   total_processed_events_(0), total_written_events_(0)
 { 
   auto analysisManager = G4AnalysisManager::Instance();
   G4cout << "Using " << analysisManager->GetType() << G4endl;
 
+  // asynchronous writer, progress meter, stepping profiler, event seeder
+  // and convergence monitor, shared by all threads (created by the master)
+  EventWriter::Instance();
+  ProgressMeter::Instance();
+  StepProfiler::Instance();
+  EventSeeder::Instance();
+  ConvergenceMonitor::Instance();
+
   // Default settings
-  analysisManager->SetNtupleMerging(true);
+  // with per-worker files (PreInit command), the ntuple rows are not sent
+  // to the master; the merging mode is set once, before the booking
+  analysisManager->SetNtupleMerging(!EventWriter::Instance()->GetPerWorkerFiles());
   analysisManager->SetVerboseLevel(1);
   analysisManager->SetFileName("hodoscope");
 
+  // event filter counters
+  auto accumulableManager = G4AccumulableManager::Instance();
+  accumulableManager->RegisterAccumulable(total_processed_events_);
+  accumulableManager->RegisterAccumulable(total_written_events_);
+
+  // acceptance counters, filled by the event action
+  accumulableManager->RegisterAccumulable(&acceptance_);
+  if(event_action_) event_action_->SetAcceptanceCounter(&acceptance_);
+
   // Creating 1D histograms
   analysisManager // H1-ID = 0
     ->CreateH1("dcin_numhit","dcin : number of hits", 10, 0., 10.);
@@ -74,7 +104,7 @@ RunAction::RunAction()
                50, -100., 100, 50, -100., 100.); 
   analysisManager  // H2-ID = 1                                                
     ->CreateH2("dcout_hitposition_xy","dcout : hit position on x-y plane;x;y", 
-               50, -100., 100, 50, -100., 100.);
+               50, -400., 400, 50, -400., 400.);
   analysisManager  // H2-ID = 2                                                
     ->CreateH2("analysis_theta_vs_cosphi","analysis : theta vs. cos(phi)", 
                180, 0., 180., 200, -1., 1.);
@@ -83,6 +113,7 @@ RunAction::RunAction()
                180, 0., 180., 200, -1., 1.);
 
   // Creating tree
+  // (dcin and dcout: first hit of the TrackingPlaneSD, see EventAction)
   analysisManager->CreateNtuple("EventTree", "Event Tree");
 
   analysisManager->CreateNtupleIColumn("dcin_nhit");        // column Id = 0
@@ -101,6 +132,25 @@ RunAction::RunAction()
   analysisManager->CreateNtupleFColumn("dcout_momentum_y"); // column Id =12
   analysisManager->CreateNtupleFColumn("dcout_momentum_z"); // column Id =13
 
+  // hodoscopes: one entry per hit segment, column IDs after the scalar ones
+  for (auto i_hodoscope = 0; i_hodoscope < Hodoscope::kTotalNumber; ++i_hodoscope) {
+    auto name = Hodoscope::detector_name[i_hodoscope];
+    auto& columns = event_action_ ? event_action_->GetHodoscopeColumns(i_hodoscope)
+                                  : master_columns_[i_hodoscope];
+    analysisManager->CreateNtupleIColumn(name+"_segment_id", columns.segment_id);
+    analysisManager->CreateNtupleFColumn(name+"_energy_deposit", columns.energy_deposit);
+    analysisManager->CreateNtupleFColumn(name+"_time", columns.time);
+    analysisManager->CreateNtupleFColumn(name+"_position_x", columns.position_x);
+    analysisManager->CreateNtupleFColumn(name+"_position_y", columns.position_y);
+    analysisManager->CreateNtupleFColumn(name+"_position_z", columns.position_z);
+  }
+
+  // the event is reproduced from (seed, run_id, event_id), see EventSeeder
+  auto id_column = analysisManager->CreateNtupleIColumn("run_id");
+  if ( event_action_ ) event_action_->SetIdColumn(id_column);
+  analysisManager->CreateNtupleIColumn("event_id");
+  analysisManager->CreateNtupleIColumn("seed");
+
   analysisManager->FinishNtuple();
 }
 
@@ -108,24 +158,45 @@ RunAction::RunAction()
 
 RunAction::~RunAction()
 {
+  if(IsMaster()){
+    delete EventWriter::Instance();
+    delete ProgressMeter::Instance();
+    delete StepProfiler::Instance();
+    delete EventSeeder::Instance();
+    delete ConvergenceMonitor::Instance();
+  }
+  delete timer_;
   delete G4AnalysisManager::Instance();  
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void RunAction::BeginOfRunAction(const G4Run* /*run*/)
+void RunAction::BeginOfRunAction(const G4Run* run)
 { 
-  G4long random_seed  = time(NULL);
-  G4int random_luxury = 5;
-  CLHEP::HepRandom::setTheSeed(random_seed,random_luxury);
+  timer_->Start();
+
+  // random engine of this thread (the events are seeded by PrimaryGeneratorAction)
+  EventSeeder::Instance()->InstallEngine();
+
+  G4AccumulableManager::Instance()->Reset();
+  if(event_action_) event_action_->GetEventFilter().ResetStatistics();
 
-  //inform the runManager to save random number seed
-  G4RunManager::GetRunManager()->SetRandomNumberStore(true);
-  G4RunManager::GetRunManager()->SetRandomNumberStoreDir("./rndm/");
+  // the writer thread is started before the workers process events
+  if(IsMaster()){
+    EventWriter::Instance()->Open(run->GetRunID());
+    ProgressMeter::Instance()->Start(run->GetNumberOfEventToBeProcessed());
+    StepProfiler::Instance()->Reset();
+    ConvergenceMonitor::Instance()->Reset();
+    // the events are reseeded by PrimaryGeneratorAction, no engine state
+    // is stored
+    EventSeeder::Instance()->PrintSeeding();
+  }
 
   // Get analysis manager
   auto analysisManager = G4AnalysisManager::Instance();
 
+  analysisManager->SetCompressionLevel(EventWriter::Instance()->GetRootCompressionLevel());
+
   // Open an output file 
   // The default file name is set in RunAction::RunAction(),
   // it can be overwritten in a macro
@@ -134,7 +205,7 @@ void RunAction::BeginOfRunAction(const G4Run* /*run*/)
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void RunAction::EndOfRunAction(const G4Run* /*run*/)
+void RunAction::EndOfRunAction(const G4Run* run)
 {
   // save histograms & ntuple
   //
@@ -142,6 +213,71 @@ void RunAction::EndOfRunAction(const G4Run* /*run*/)
   analysisManager->Write();
   analysisManager->CloseFile();
 
+  // step storage statistics of this thread, then release the memory
+  // above the high-water mark of this run
+  HodoscopeStepStore::PrintStatistics();
+  HodoscopeStepStore::TrimPool();
+
+  // event filter counters of this thread, summed on the master
+  if(event_action_){
+    const auto& filter = event_action_->GetEventFilter();
+    total_processed_events_ += filter.GetTotalProcessed();
+    total_written_events_ += filter.GetTotalAccepted();
+  }
+  G4AccumulableManager::Instance()->Merge();
+
+  // stepping profile of this thread, reported by the master
+  StepProfiler::Instance()->Merge();
+  if(IsMaster()) StepProfiler::Instance()->Report(run->GetRunID());
+
+  // per-worker files: close the file of this thread
+  EventWriter::Instance()->CloseWorkerFile();
+
+  // the workers are done: stop the progress reports and drain the queue
+  // of the asynchronous writer
+  if(IsMaster()){
+    ProgressMeter::Instance()->Stop();
+    auto writer = EventWriter::Instance();
+    if(writer->IsOpen()){
+      writer->Close();
+      writer->PrintStatistics();
+    }
+  }
+
+  // throughput
+  timer_->Stop();
+
+  // steps processed by the hodoscopes of this thread
+  // (the sensitive detectors are not constructed on the master in MT mode)
+  auto elapsed = timer_->GetRealElapsed();
+  for(const auto& name: Hodoscope::detector_name){
+    auto sd = static_cast<HodoscopeSD*>(
+        G4SDManager::GetSDMpointer()->FindSensitiveDetector(name,false));
+    if(!sd) continue;
+    G4cout << " " << name << " : " << sd->GetTotalSteps() << " steps, "
+           << sd->GetTotalRecords() << " recorded";
+    if(elapsed>0.) G4cout << ", " << sd->GetTotalSteps()/elapsed << " steps/s";
+    G4cout << G4endl;
+    sd->ResetStatistics();
+  }
+
+  if(IsMaster()){
+    auto total_events = run->GetNumberOfEvent();
+    G4cout << "-------------------------------------" << G4endl;
+    G4cout << " events     : " << total_events << G4endl;
+    G4cout << " written    : " << total_written_events_.GetValue() << " / "
+           << total_processed_events_.GetValue() << " (event filter)" << G4endl;
+    G4cout << " wall time  : " << elapsed << " s" << G4endl;
+    // user and system times of the process (all the threads)
+    G4cout << " cpu time   : " << timer_->GetUserElapsed()+timer_->GetSystemElapsed()
+           << " s" << G4endl;
+    if(elapsed>0.){
+      G4cout << " throughput : " << total_events/elapsed << " events/s" << G4endl;
+    }
+    ConvergenceMonitor::Instance()->Print();
+    acceptance_.Print();
+    G4cout << "-------------------------------------" << G4endl;
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,333 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file StepProfiler.cc
+/// \brief Implementation of the StepProfiler class
+
+#include "StepProfiler.hh"
+
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4StepPoint.hh"
+#include "G4VProcess.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4GenericMessenger.hh"
+#include "G4AutoLock.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#include <time.h>
+
+namespace {
+  G4Mutex merge_mutex = G4MUTEX_INITIALIZER;
+
+  // tables of a thread, keyed by pointer
+  struct ThreadTables {
+    std::unordered_map<const G4LogicalVolume*, StepProfiler::Entry> volumes;
+    std::unordered_map<const G4ParticleDefinition*, StepProfiler::Entry> particles;
+    std::unordered_map<const G4VProcess*, StepProfiler::Entry> processes;
+    G4double last_cpu_time = 0.;
+  };
+  G4ThreadLocal ThreadTables* thread_tables = nullptr;
+
+  inline ThreadTables* GetThreadTables()
+  {
+    if(!thread_tables) thread_tables = new ThreadTables();
+    return thread_tables;
+  }
+
+  // JSON string of a name (quotes, backslashes and control characters
+  // escaped)
+  std::string EscapeJson(const std::string& name)
+  {
+    std::ostringstream escaped;
+    for(auto character: name){
+      switch(character){
+        case '"':  escaped << "\\\""; break;
+        case '\\': escaped << "\\\\"; break;
+        case '\n': escaped << "\\n"; break;
+        case '\t': escaped << "\\t"; break;
+        default:
+          if((unsigned char)character<0x20){
+            escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                    << (int)character << std::dec;
+          }
+          else escaped << character;
+      }
+    }
+    return escaped.str();
+  }
+
+  // CPU time of the calling thread [s]
+  inline G4double GetThreadCpuTime()
+  {
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID,&now);
+    return now.tv_sec+1.e-9*now.tv_nsec;
+  }
+
+  inline void Add(StepProfiler::Entry& entry, const G4double length, const G4double cpu_time)
+  {
+    entry.total_steps++;
+    entry.track_length += length;
+    entry.cpu_time += cpu_time;
+  }
+
+  inline void Add(StepProfiler::Entry& entry, const StepProfiler::Entry& other)
+  {
+    entry.total_steps += other.total_steps;
+    entry.total_tracks += other.total_tracks;
+    entry.track_length += other.track_length;
+    entry.cpu_time += other.cpu_time;
+  }
+
+  // entries sorted by decreasing CPU time
+  std::vector<std::pair<G4String, StepProfiler::Entry>> Sort(const StepProfiler::Table& table)
+  {
+    std::vector<std::pair<G4String, StepProfiler::Entry>> entries(table.begin(),table.end());
+    std::sort(entries.begin(),entries.end(),
+        [](const std::pair<G4String, StepProfiler::Entry>& a,
+           const std::pair<G4String, StepProfiler::Entry>& b)
+        { return a.second.cpu_time>b.second.cpu_time; });
+    return entries;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StepProfiler* StepProfiler::instance_ = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StepProfiler* StepProfiler::Instance()
+{
+  // created by the master before the workers start
+  if(!instance_) instance_ = new StepProfiler();
+  return instance_;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StepProfiler::StepProfiler()
+: enabled_(false), file_name_("profile"), total_rows_(20),
+  messenger_(nullptr)
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StepProfiler::~StepProfiler()
+{
+  delete messenger_;
+  instance_ = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StepProfiler::DefineCommands()
+{
+  // Define /hodoscope/profile/ command directory using generic messenger class
+  messenger_ 
+    = new G4GenericMessenger(this, 
+        "/hodoscope/profile/", 
+        "Stepping profiler control");
+
+  // enable command
+  auto& enableCmd
+    = messenger_->DeclareProperty("enable", enabled_,
+        "Profile the steps per volume, particle and process.");
+  enableCmd.SetParameterName("flg", true);
+  enableCmd.SetDefaultValue("true");
+  enableCmd.SetStates(G4State_PreInit, G4State_Idle);
+  enableCmd.SetToBeBroadcasted(false);
+
+  // fileName command
+  auto& fileCmd
+    = messenger_->DeclareProperty("fileName", file_name_,
+        "Base name of the JSON report (<name>_run<ID>.json).");
+  fileCmd.SetParameterName("name", false);
+  fileCmd.SetStates(G4State_PreInit, G4State_Idle);
+  fileCmd.SetToBeBroadcasted(false);
+
+  // rows command
+  auto& rowsCmd
+    = messenger_->DeclareProperty("rows", total_rows_,
+        "Number of rows printed per table (all of them are written to the JSON report).");
+  rowsCmd.SetParameterName("rows", false);
+  rowsCmd.SetRange("rows>0");
+  rowsCmd.SetStates(G4State_PreInit, G4State_Idle);
+  rowsCmd.SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StepProfiler::BeginOfTrack(const G4Track* track)
+{
+  auto tables = GetThreadTables();
+  tables->particles[track->GetParticleDefinition()].total_tracks++;
+  tables->last_cpu_time = GetThreadCpuTime();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StepProfiler::Step(const G4Step* step)
+{
+  auto tables = GetThreadTables();
+  auto now = GetThreadCpuTime();
+  auto cpu_time = now-tables->last_cpu_time;
+  tables->last_cpu_time = now;
+
+  auto length = step->GetStepLength();
+  auto pre_volume = step->GetPreStepPoint()->GetPhysicalVolume();
+  auto volume = pre_volume ? pre_volume->GetLogicalVolume() : nullptr;
+  Add(tables->volumes[volume],length,cpu_time);
+  Add(tables->particles[step->GetTrack()->GetParticleDefinition()],length,cpu_time);
+  Add(tables->processes[step->GetPostStepPoint()->GetProcessDefinedStep()],length,cpu_time);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StepProfiler::Merge()
+{
+  if(!thread_tables) return;
+
+  G4AutoLock lock(&merge_mutex);
+  for(const auto& entry: thread_tables->volumes){
+    Add(volumes_[entry.first ? entry.first->GetName() : G4String("(none)")],entry.second);
+  }
+  for(const auto& entry: thread_tables->particles){
+    Add(particles_[entry.first ? entry.first->GetParticleName() : G4String("(none)")],entry.second);
+  }
+  for(const auto& entry: thread_tables->processes){
+    Add(processes_[entry.first ? entry.first->GetProcessName() : G4String("(none)")],entry.second);
+  }
+
+  delete thread_tables;
+  thread_tables = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StepProfiler::Reset()
+{
+  volumes_.clear();
+  particles_.clear();
+  processes_.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StepProfiler::PrintTable(const G4String& title, const Table& table,
+    const G4bool with_tracks) const
+{
+  G4double total_cpu_time = 0.;
+  for(const auto& entry: table) total_cpu_time += entry.second.cpu_time;
+
+  G4cout << "-------------------------------------" << G4endl;
+  G4cout << " " << std::left << std::setw(24) << title << std::right
+         << std::setw(12) << "steps";
+  if(with_tracks) G4cout << std::setw(12) << "tracks";
+  G4cout << std::setw(14) << "length [m]" << std::setw(12) << "cpu [s]"
+         << std::setw(8) << "cpu %" << G4endl;
+
+  G4int i_row = 0;
+  for(const auto& entry: Sort(table)){
+    if(i_row++>=total_rows_) break;
+    G4cout << " " << std::left << std::setw(24) << entry.first << std::right
+           << std::setw(12) << entry.second.total_steps;
+    if(with_tracks) G4cout << std::setw(12) << entry.second.total_tracks;
+    G4cout << std::setw(14) << std::setprecision(4) << entry.second.track_length/m
+           << std::setw(12) << entry.second.cpu_time
+           << std::setw(8) << std::setprecision(3)
+           << (total_cpu_time>0. ? 100.*entry.second.cpu_time/total_cpu_time : 0.)
+           << G4endl;
+  }
+  G4cout << std::setprecision(6);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StepProfiler::WriteTable(std::ostream& file, const G4String& name,
+    const Table& table) const
+{
+  file << "  \"" << name << "\": [";
+  G4bool first = true;
+  for(const auto& entry: Sort(table)){
+    file << (first ? "\n" : ",\n");
+    first = false;
+    file << "    {\"name\": \"" << EscapeJson(entry.first) << "\""
+         << ", \"steps\": " << entry.second.total_steps
+         << ", \"tracks\": " << entry.second.total_tracks
+         << ", \"track_length_mm\": " << entry.second.track_length/mm
+         << ", \"cpu_time_s\": " << entry.second.cpu_time << "}";
+  }
+  file << "\n  ]";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StepProfiler::Report(const G4int run_id) const
+{
+  if(!enabled_) return;
+
+  G4cout << "-------------------------------------" << G4endl;
+  G4cout << " stepping profile of run " << run_id << G4endl;
+  PrintTable("volume",volumes_,false);
+  PrintTable("particle",particles_,true);
+  PrintTable("process",processes_,false);
+  G4cout << "-------------------------------------" << G4endl;
+
+  std::ostringstream file_name;
+  file_name << file_name_ << "_run" << run_id << ".json";
+  std::ofstream file(file_name.str().c_str());
+  if(!file){
+    G4ExceptionDescription msg;
+    msg << "Cannot open " << file_name.str() << ", the profile is not written." << G4endl; 
+    G4Exception("StepProfiler::Report()",
+        "Code004", JustWarning, msg);
+    return;
+  }
+  file << std::setprecision(9);
+  file << "{\n  \"run\": " << run_id << ",\n";
+  WriteTable(file,"volumes",volumes_);
+  file << ",\n";
+  WriteTable(file,"particles",particles_);
+  file << ",\n";
+  WriteTable(file,"processes",processes_);
+  file << "\n}\n";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,110 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \copied from B5DriftChamberHit.cc
+/// \brief Implementation of the TrackingPlaneHit class
+
+#include "TrackingPlaneHit.hh"
+#include "Constants.hh"
+
+#include "G4VVisManager.hh"
+#include "G4VisAttributes.hh"
+#include "G4Circle.hh"
+#include "G4UnitsTable.hh"
+#include "G4ios.hh"
+
+G4ThreadLocal G4Allocator<TrackingPlaneHit>* TrackingPlaneHitAllocator;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TrackingPlaneHit::TrackingPlaneHit()
+: G4VHit(), 
+  track_id_(-1), particle_id_(0), hit_time_(0.),
+  global_position_(0), momentum_(0)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TrackingPlaneHit::~TrackingPlaneHit()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TrackingPlaneHit::TrackingPlaneHit(const TrackingPlaneHit &right)
+: G4VHit(),
+  track_id_(right.track_id_),
+  particle_id_(right.particle_id_),
+  hit_time_(right.hit_time_),
+  global_position_(right.global_position_),
+  momentum_(right.momentum_)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const TrackingPlaneHit& TrackingPlaneHit::operator=(const TrackingPlaneHit &right)
+{
+  track_id_ = right.track_id_;
+  particle_id_ = right.particle_id_;
+  hit_time_ = right.hit_time_;
+  global_position_ = right.global_position_;
+  momentum_ = right.momentum_;
+
+  return *this;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TrackingPlaneHit::operator==(const TrackingPlaneHit &/*right*/) const
+{
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TrackingPlaneHit::Draw()
+{
+  auto vis_manager = G4VVisManager::GetConcreteInstance();
+  if (! vis_manager) return;
+
+  G4Circle circle(global_position_);
+  circle.SetScreenSize(5);
+  circle.SetFillStyle(G4Circle::filled);
+  G4VisAttributes attributes(MyColour::Hit());
+  circle.SetVisAttributes(attributes);
+  vis_manager->Draw(circle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TrackingPlaneHit::Print()
+{
+  G4cout << "  track " << track_id_ << " (" << particle_id_ << ") : time "
+         << G4BestUnit(hit_time_,"Time") << " position "
+         << G4BestUnit(global_position_,"Length") << " momentum "
+         << G4BestUnit(momentum_,"Energy") << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,87 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \copied from B5DriftChamberSD.cc
+/// \brief Implementation of the TrackingPlaneSD class
+
+#include "TrackingPlaneSD.hh"
+#include "TrackingPlaneHit.hh"
+
+#include "G4HCofThisEvent.hh"
+#include "G4TouchableHistory.hh"
+#include "G4Track.hh"
+#include "G4Step.hh"
+#include "G4SDManager.hh"
+#include "G4ios.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TrackingPlaneSD::TrackingPlaneSD(G4String name)
+: G4VSensitiveDetector(name), 
+  hits_collection_(nullptr), hits_collection_id_(-1)
+{
+  collectionName.insert("tracking_plane_hitscollection");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TrackingPlaneSD::~TrackingPlaneSD()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TrackingPlaneSD::Initialize(G4HCofThisEvent* collection)
+{
+  hits_collection_ 
+    = new TrackingPlaneHitsCollection(SensitiveDetectorName,collectionName[0]);
+
+  if (hits_collection_id_<0) { 
+    hits_collection_id_ = G4SDManager::GetSDMpointer()->GetCollectionID(hits_collection_); 
+  }
+  collection->AddHitsCollection(hits_collection_id_,hits_collection_);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TrackingPlaneSD::ProcessHits(G4Step* step, G4TouchableHistory*)
+{
+  // only the steps entering the plane
+  auto pre_steppoint = step->GetPreStepPoint();
+  if(pre_steppoint->GetStepStatus()!=fGeomBoundary) return true;
+
+  auto track = step->GetTrack();
+  auto hit = new TrackingPlaneHit();
+  hit->SetTrackID(track->GetTrackID());
+  hit->SetParticleID(track->GetParticleDefinition()->GetPDGEncoding());
+  hit->SetHitTime(pre_steppoint->GetGlobalTime());
+  hit->SetGlobalPosition(pre_steppoint->GetPosition());
+  hit->SetMomentum(pre_steppoint->GetMomentum());
+  hits_collection_->insert(hit);
+
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
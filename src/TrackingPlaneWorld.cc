@@ -0,0 +1,95 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file TrackingPlaneWorld.cc
+/// \brief Implementation of the TrackingPlaneWorld class
+
+#include "TrackingPlaneWorld.hh"
+#include "TrackingPlaneSD.hh"
+
+#include "G4Tubs.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4PVPlacement.hh"
+#include "G4SDManager.hh"
+#include "G4SystemOfUnits.hh"
+
+namespace {
+  // radius and length of the planes, in the order of TrackingPlane::detector_name:
+  // dcin just outside the target, dcout just inside the cdh
+  const std::array<G4double, TrackingPlane::kTotalNumber> kPlaneRadius
+    = {{ 60.*mm, 370.*mm }};
+  const std::array<G4double, TrackingPlane::kTotalNumber> kPlaneLength
+    = {{ 1000.*mm, 1000.*mm }};
+  const G4double kPlaneThickness = 1.*um;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TrackingPlaneWorld::TrackingPlaneWorld(G4String world_name)
+: G4VUserParallelWorld(world_name)
+{
+  plane_logical_.fill(nullptr);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TrackingPlaneWorld::~TrackingPlaneWorld()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TrackingPlaneWorld::Construct()
+{
+  G4bool kCheckOverlaps = true;
+
+  auto world_logical = GetWorld()->GetLogicalVolume();
+
+  for(auto i_plane = 0; i_plane < TrackingPlane::kTotalNumber; ++i_plane){
+    auto name = TrackingPlane::detector_name[i_plane];
+    auto plane_solid
+      = new G4Tubs(name+"_solid",kPlaneRadius[i_plane],kPlaneRadius[i_plane]+kPlaneThickness,
+          kPlaneLength[i_plane]/2.,0.*deg,360.*deg);
+    // no material in a parallel world
+    plane_logical_[i_plane] = new G4LogicalVolume(plane_solid,nullptr,name+"_logical");
+    new G4PVPlacement(0,G4ThreeVector(),plane_logical_[i_plane],name+"_physical",
+        world_logical,false,i_plane,kCheckOverlaps);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TrackingPlaneWorld::ConstructSD()
+{
+  auto sdManager = G4SDManager::GetSDMpointer();
+  for(auto i_plane = 0; i_plane < TrackingPlane::kTotalNumber; ++i_plane){
+    auto plane = new TrackingPlaneSD("/"+TrackingPlane::detector_name[i_plane]);
+    sdManager->AddNewDetector(plane);
+    SetSensitiveDetector(plane_logical_[i_plane],plane);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......